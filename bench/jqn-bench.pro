@@ -0,0 +1,33 @@
+TEMPLATE  = app
+TARGET    = jqn-bench
+
+QT       += network widgets
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# no web view, render ops are replayed straight into the engine
+DEFINES  += JQN_HEADLESS
+
+INCLUDEPATH += ..
+
+HEADERS   = ../qt/core.h \
+            ../qt/engine.h \
+            ../qt/flexlayout.h \
+            ../qt/images.h \
+            ../qt/prepare.h \
+            ../qt/profiler.h \
+            ../qt/props.h \
+            ../qt/recorder.h \
+            ../qt/stats.h \
+            ../qt/style.h
+
+SOURCES   = ../qt/core.cpp \
+            ../qt/engine.cpp \
+            ../qt/flexlayout.cpp \
+            ../qt/images.cpp \
+            ../qt/prepare.cpp \
+            ../qt/profiler.cpp \
+            ../qt/recorder.cpp \
+            ../qt/stats.cpp \
+            ../qt/style.cpp \
+            main.cpp
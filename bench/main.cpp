@@ -0,0 +1,228 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "qt/core.h"
+#include "qt/engine.h"
+#include "qt/profiler.h"
+#include "qt/recorder.h"
+#include "qt/style.h"
+
+// headless render benchmark
+//
+// replays a trace recorded with --record (see qt/recorder.h) without
+// WebKit and reports the time spent in each stage of the render
+// pipeline. each recorded render tick is replayed as one bench tick.
+// without a trace a synthetic mount/update/unmount workload is generated
+
+static const char* sections[] = {
+    "toJson",
+    "create",
+    "applyStyle",
+    "relayout",
+    "setStyleSheet",
+    "layout",
+    "render",
+    0
+};
+
+static long peakRss()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        // kilobytes on linux
+        return usage.ru_maxrss;
+    }
+#endif
+    return 0;
+}
+
+typedef QList<TraceRecord> Tick;
+
+static Tick commit(QJsonArray ops)
+{
+    TraceRecord record;
+    record.time = 0;
+    record.op = "commit";
+    record.payload = QString(QJsonDocument(ops).toJson(QJsonDocument::Compact));
+    return Tick({ record });
+}
+
+static QList<Tick> synthetic(int nodes, int base)
+{
+    QList<Tick> ticks;
+    int rows = nodes / 2;
+
+    // mount: a column of rows, each with a text, and a window sheet
+    // with a hover rule
+    QJsonArray mounts;
+    QJsonObject hover;
+    hover.insert("QFrame[className~=\"hover\"]", QJsonObject({ { "background-color", "#ddd" } }));
+    mounts.append(QJsonObject({ { "op", "update" }, { "node", QJsonObject({ { "id", "mainWindow" }, { "qss", hover } }) } }));
+    for (int i = 0; i < rows; i++) {
+        int row = base + i * 2;
+        // dashed keys, as distillStyle sends them
+        QJsonObject style;
+        style.insert("flex-direction", "row");
+        style.insert("padding", 4);
+        style.insert("background-color", i % 2 ? "#eee" : "#fff");
+        mounts.append(QJsonObject({ { "op", "mount" }, { "node", QJsonObject({ { "id", row }, { "type", "View" }, { "parent", "mainWindow" }, { "order", i }, { "style", style } }) } }));
+        mounts.append(QJsonObject({ { "op", "mount" }, { "node", QJsonObject({ { "id", row + 1 }, { "type", "Text" }, { "parent", row }, { "text", QString("row %1").arg(i) } }) } }));
+    }
+    ticks << commit(mounts);
+
+    // update: touch every text, then restyle every other row
+    for (int pass = 0; pass < 4; pass++) {
+        QJsonArray updates;
+        for (int i = 0; i < rows; i++) {
+            int row = base + i * 2;
+            updates.append(QJsonObject({ { "op", "update" }, { "node", QJsonObject({ { "id", row + 1 }, { "text", QString("row %1 pass %2").arg(i).arg(pass) } }) } }));
+            if ((i + pass) % 2) {
+                QJsonObject style;
+                style.insert("flex-direction", "row");
+                style.insert("padding", 4 + pass);
+                updates.append(QJsonObject({ { "op", "update" }, { "node", QJsonObject({ { "id", row }, { "style", style } }) } }));
+            }
+        }
+        ticks << commit(updates);
+    }
+
+    // unmount half of the rows
+    QJsonArray unmounts;
+    for (int i = 0; i < rows; i += 2) {
+        unmounts.append(QJsonObject({ { "op", "unmount" }, { "node", QJsonObject({ { "id", base + i * 2 } }) } }));
+    }
+    ticks << commit(unmounts);
+
+    return ticks;
+}
+
+static QList<Tick> load(QString path)
+{
+    QList<Tick> ticks;
+    Tick tick;
+    for (auto record : Replayer::load(path)) {
+        if (record.op == "render") {
+            ticks << tick;
+            tick.clear();
+            continue;
+        }
+        tick << record;
+    }
+    if (tick.size()) {
+        ticks << tick;
+    }
+    return ticks;
+}
+
+int main(int argc, char** argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    QCommandLineOption traceOption({ "t", "trace" }, "trace file to replay", "path", "");
+    QCommandLineOption syntheticOption({ "s", "synthetic" }, "synthetic workload node count", "nodes", "1000");
+    QCommandLineOption repeatOption({ "r", "repeat" }, "replay the trace n times", "n", "1");
+    parser.addHelpOption();
+    parser.addOption(traceOption);
+    parser.addOption(syntheticOption);
+    parser.addOption(repeatOption);
+    parser.process(app);
+
+    Engine engine;
+    engine.addFactory(new UICoreFactory());
+
+    UIObject* mainWindow = engine.create("mainWindow", "Window", true);
+    mainWindow->widget()->resize(800, 600);
+    mainWindow->widget()->show();
+
+    QList<Tick> ticks;
+    if (parser.value(traceOption) != "") {
+        ticks = load(parser.value(traceOption));
+    } else {
+        // handles are reserved the same way the js side does
+        int nodes = parser.value(syntheticOption).toInt();
+        QVariantList handles = engine.reserveHandles(nodes);
+        ticks = synthetic(nodes, handles.value(0, 1).toInt());
+    }
+
+    Profiler::setEnabled(true);
+
+    QTextStream out(stdout);
+    out << "tick";
+    for (int s = 0; sections[s]; s++) {
+        out << "\t" << sections[s];
+    }
+    out << "\ttotal\tnodes\trss_kb\n";
+
+    QMap<QString, qint64> sum;
+    QElapsedTimer total;
+    total.start();
+
+    int repeat = qMax(1, parser.value(repeatOption).toInt());
+    int tick = 0;
+    for (int r = 0; r < repeat; r++) {
+        for (auto records : ticks) {
+            QElapsedTimer timer;
+            timer.start();
+
+            for (auto record : records) {
+                Replayer::apply(&engine, record);
+            }
+            engine.flush();
+            {
+                PROFILE_SCOPE("layout");
+                QCoreApplication::sendPostedEvents(0, QEvent::LayoutRequest);
+            }
+
+            qint64 elapsed = timer.nsecsElapsed();
+            QMap<QString, qint64> times = Profiler::take();
+
+            out << tick++;
+            for (int s = 0; sections[s]; s++) {
+                qint64 ns = times.value(sections[s]);
+                sum[sections[s]] += ns;
+                out << "\t" << QString::number(ns / 1000000.0, 'f', 3);
+            }
+            out << "\t" << QString::number(elapsed / 1000000.0, 'f', 3);
+            out << "\t" << engine.nodeCount();
+            out << "\t" << peakRss() << "\n";
+            out.flush();
+
+            // let deferred deletes and queued events settle between ticks
+            QCoreApplication::processEvents();
+            Profiler::take();
+        }
+    }
+
+    out << "sum";
+    for (int s = 0; sections[s]; s++) {
+        out << "\t" << QString::number(sum[sections[s]] / 1000000.0, 'f', 3);
+    }
+    out << "\t" << QString::number(total.nsecsElapsed() / 1000000.0, 'f', 3);
+    out << "\t" << engine.nodeCount();
+    out << "\t" << peakRss() << "\n";
+
+    // the synthetic window sheet selects hovered widgets by class, it
+    // must be seen as a hover rule or hovering won't restyle anything
+    if (parser.value(traceOption) == "" && !StyleCompiler::hasHoverRules()) {
+        qDebug() << "hover rules not detected";
+        return 1;
+    }
+
+    return 0;
+}
@@ -3,8 +3,23 @@ TARGET   = jqn
 QT       += webkitwidgets network widgets
 
 HEADERS   = qt/core.h \
-            qt/engine.h
+            qt/engine.h \
+            qt/flexlayout.h \
+            qt/images.h \
+            qt/prepare.h \
+            qt/profiler.h \
+            qt/props.h \
+            qt/recorder.h \
+            qt/stats.h \
+            qt/style.h
 
 SOURCES   = qt/core.cpp \
             qt/engine.cpp \
+            qt/flexlayout.cpp \
+            qt/images.cpp \
+            qt/prepare.cpp \
+            qt/profiler.cpp \
+            qt/recorder.cpp \
+            qt/stats.cpp \
+            qt/style.cpp \
             main.cpp
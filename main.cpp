@@ -8,6 +8,8 @@
 
 #include "qt/engine.h"
 #include "qt/core.h"
+#include "qt/images.h"
+#include "qt/recorder.h"
 
 int main(int argc, char **argv) {
     QApplication app(argc, argv);
@@ -18,21 +20,69 @@ int main(int argc, char **argv) {
     QCommandLineOption htmlOption({ "m", "html" }, "inspect with html view");
     QCommandLineOption entryOption({ "e", "entry" }, "set entry script", "entry", "");
     QCommandLineOption hostOption({ "x", "host" }, "development host", "host", "");
+    QCommandLineOption imageCacheOption({ "c", "image-cache" }, "on-disk image cache directory", "path", "");
+    QCommandLineOption frameOption({ "f", "frame-interval" }, "min and max frame interval in ms", "min,max", "");
+    QCommandLineOption budgetOption({ "b", "frame-budget" }, "render time per frame in ms before yielding", "ms", "");
+    QCommandLineOption progressiveOption({ "progressive" }, "attach subtrees while they are being built");
+    QCommandLineOption prepareOption({ "prepare-threads" }, "worker threads parsing bridge calls, 0 for none", "count", "");
+    QCommandLineOption recordOption({ "r", "record" }, "record bridge calls to a trace file", "path", "");
+    QCommandLineOption replayOption({ "p", "replay" }, "replay a recorded trace instead of running scripts", "path", "");
+    QCommandLineOption fastOption({ "fast" }, "replay as fast as possible");
+    QCommandLineOption statsOption({ "s", "stats" }, "show engine stats overlay");
     parser.addHelpOption();
     parser.addOption(inspectOption);
     parser.addOption(htmlOption);
     parser.addOption(entryOption);
     parser.addOption(hostOption);
+    parser.addOption(frameOption);
+    parser.addOption(imageCacheOption);
+    parser.addOption(budgetOption);
+    parser.addOption(progressiveOption);
+    parser.addOption(prepareOption);
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(fastOption);
+    parser.addOption(statsOption);
     parser.process(app);
 
     Engine engine;
     engine.addFactory(new UICoreFactory());
+
+    if (parser.value(imageCacheOption) != "") {
+        engine.imageLoader()->setDiskCache(parser.value(imageCacheOption), 256 * 1024 * 1024);
+    }
+
+    if (parser.value(frameOption) != "") {
+        QStringList interval = parser.value(frameOption).split(",");
+        int minInterval = interval.value(0).toInt();
+        int maxInterval = interval.value(1, interval.value(0)).toInt();
+        engine.setFrameInterval(minInterval, maxInterval);
+    }
+
+    if (parser.value(budgetOption) != "") {
+        engine.setFrameBudget(parser.value(budgetOption).toInt(), parser.isSet(progressiveOption));
+    }
+
+    if (parser.value(prepareOption) != "") {
+        engine.setPrepareThreads(parser.value(prepareOption).toInt());
+    }
+
+    if (parser.value(recordOption) != "") {
+        engine.record(parser.value(recordOption));
+    }
+
     UIObject *obj = engine.create("mainWindow", "Window", true);
 
     qDebug() << obj;
     // engine.mount("{ \"id\": \"mainWindow\", \"type\": \"MainWindow\", \"persist\": true }");
 
-    if (parser.value(hostOption) != "") {
+    Replayer replayer(&engine);
+
+    if (parser.value(replayOption) != "") {
+        if (replayer.open(parser.value(replayOption))) {
+            replayer.start(!parser.isSet(fastOption));
+        }
+    } else if (parser.value(hostOption) != "") {
         // qDebug() << "host";
         engine.runFromUrl(QUrl(parser.value(hostOption)));
     } else if (parser.value(entryOption) != "") {
@@ -45,6 +95,10 @@ int main(int argc, char **argv) {
         // todo load from qrc <deployed app>
     }
 
+    if (parser.isSet(statsOption)) {
+        engine.showStats(true);
+    }
+
     if (parser.isSet(inspectOption)) {
         engine.showInspector(parser.isSet(htmlOption));
     }
@@ -1,5 +1,8 @@
 #include "core.h"
 #include "engine.h"
+#include "images.h"
+#include "profiler.h"
+#include "style.h"
 
 #include <QApplication>
 #include <QFileInfo>
@@ -12,6 +15,8 @@
 #include <QNetworkRequest>
 #include <QStyle>
 
+#include <algorithm>
+
 QJsonObject toJson(QString json)
 {
     QByteArray bytes;
@@ -25,8 +30,22 @@ QString toStyle(QJsonObject json)
     static const QStringList remove = {
         "flex",
         "flex-direction",
+        "flex-wrap",
+        "flex-grow",
+        "flex-shrink",
+        "flex-basis",
         "align-items",
+        "align-content",
+        "align-self",
         "justify-content",
+        "gap",
+        "row-gap",
+        "column-gap",
+        "position",
+        "left",
+        "top",
+        "right",
+        "bottom",
         "visible",
         "icon-width",
         "icon-height"
@@ -52,22 +71,190 @@ QString toQss(QJsonObject json) {
     return sheet;
 }
 
+static const QStringList& styleKeys()
+{
+    static const QStringList keys = {
+        "id",
+        "order",
+        "className",
+        "permanent",
+        "style",
+        "styleId",
+        "qss",
+        "row"
+    };
+    return keys;
+}
+
+uint styleFingerprint(QJsonObject json)
+{
+    QJsonObject fingerprint;
+    for (auto k : styleKeys()) {
+        if (json.contains(k)) {
+            fingerprint.insert(k, json.value(k));
+        }
+    }
+    return qHash(QJsonDocument(fingerprint).toJson(QJsonDocument::Compact));
+}
+
+static const PropField<NodeProps> nodeSchema[] = {
+    PROP_FIELD(NodeProps, "order", Order, int, order),
+    PROP_FIELD(NodeProps, "className", ClassName, QString, className),
+    PROP_FIELD(NodeProps, "permanent", Permanent, bool, permanent),
+    PROP_FIELD(NodeProps, "row", Row, int, row)
+};
+
+static const PropField<NodeProps> layoutSchema[] = {
+    PROP_FIELD(NodeProps, "flex", Flex, double, flex),
+    PROP_FIELD(NodeProps, "flex-direction", FlexDirection, QString, flexDirection),
+    PROP_FIELD(NodeProps, "align-items", AlignItems, QString, alignItems),
+    PROP_FIELD(NodeProps, "justify-content", JustifyContent, QString, justifyContent),
+    PROP_FIELD(NodeProps, "flex-wrap", FlexWrap, QString, flexWrap),
+    PROP_FIELD(NodeProps, "align-content", AlignContent, QString, alignContent),
+    PROP_FIELD(NodeProps, "gap", Gap, int, gap),
+    PROP_FIELD(NodeProps, "row-gap", Gap, int, rowGap),
+    PROP_FIELD(NodeProps, "column-gap", Gap, int, columnGap),
+    PROP_FIELD(NodeProps, "flex-grow", FlexGrow, double, flexGrow),
+    PROP_FIELD(NodeProps, "flex-shrink", FlexShrink, double, flexShrink),
+    PROP_FIELD(NodeProps, "flex-basis", FlexBasis, FlexLength, flexBasis),
+    PROP_FIELD(NodeProps, "width", Size, FlexLength, width),
+    PROP_FIELD(NodeProps, "height", Size, FlexLength, height),
+    PROP_FIELD(NodeProps, "align-self", AlignSelf, QString, alignSelf),
+    PROP_FIELD(NodeProps, "position", Position, QString, position),
+    PROP_FIELD(NodeProps, "left", Offset, FlexLength, left),
+    PROP_FIELD(NodeProps, "top", Offset, FlexLength, top),
+    PROP_FIELD(NodeProps, "right", Offset, FlexLength, right),
+    PROP_FIELD(NodeProps, "bottom", Offset, FlexLength, bottom)
+};
+
+// the flexbox view of a node's props, for its own FlexLayout and its
+// place in the parent's
+static FlexStyle flexStyleOf(const NodeProps& props)
+{
+    FlexStyle s;
+    s.direction = props.flexDirection;
+    s.wrap = props.flexWrap;
+    s.justifyContent = props.justifyContent;
+    s.alignItems = props.alignItems;
+    s.alignContent = props.alignContent;
+    s.rowGap = props.rowGap ? props.rowGap : props.gap;
+    s.columnGap = props.columnGap ? props.columnGap : props.gap;
+    s.flex = props.flex;
+    s.grow = props.flexGrow;
+    s.shrink = props.flexShrink;
+    s.basis = props.flexBasis;
+    s.width = props.width;
+    s.height = props.height;
+    s.alignSelf = props.alignSelf;
+    s.position = props.position;
+    s.left = props.left;
+    s.top = props.top;
+    s.right = props.right;
+    s.bottom = props.bottom;
+    return s;
+}
+
+static const PropField<TextProps> textSchema[] = {
+    PROP_FIELD(TextProps, "text", Text, QString, text),
+    PROP_FIELD(TextProps, "renderedText", RenderedText, QString, renderedText)
+};
+
+static const PropField<TextInputProps> textInputSchema[] = {
+    PROP_FIELD(TextInputProps, "text", Text, QString, text),
+    PROP_FIELD(TextInputProps, "placeholder", Placeholder, QString, placeholder)
+};
+
+static const PropField<ButtonProps> buttonSchema[] = {
+    PROP_FIELD(ButtonProps, "text", Text, QString, text),
+    PROP_FIELD(ButtonProps, "checked", Checked, bool, checked),
+    PROP_FIELD(ButtonProps, "checkable", Checkable, bool, checkable),
+    PROP_FIELD(ButtonProps, "icon", Icon, QString, icon)
+};
+
+static const PropField<ImageProps> imageSchema[] = {
+    PROP_FIELD(ImageProps, "source", Source, QString, source)
+};
+
+static QJsonObject styleOf(UIObject* obj, QJsonObject json)
+{
+    if (json.contains("styleId") && obj->engine) {
+        return obj->engine->style(json.value("styleId").toInt());
+    }
+    return json.value("style").toObject();
+}
+
 static void applyStyle(QString qtWidgetName, UIObject* obj, QJsonObject json)
 {
+    PROFILE_SCOPE("applyStyle");
+
     QWidget* w = obj->widget();
     if (!w) {
         return;
     }
-    w->setProperty("id", json.value("id").toString());
-    w->setProperty("order", json.value("order").toInt());
-    w->setProperty("className", json.value("className").toString());
-    w->setProperty("permanent", json.contains("permanent"));
 
-    // qDebug() << w->property("className").toString();
+    // updates are patches, nothing to do unless one of the style props
+    // is in it. the others come from the node's retained state
+    QJsonObject patch = json;
+    bool touched = false;
+    for (auto k : styleKeys()) {
+        if (k != "id" && patch.contains(k)) {
+            touched = true;
+            break;
+        }
+    }
+    if (!touched && obj->styleHash != 0) {
+        return;
+    }
+    if (!obj->state.isEmpty()) {
+        json = obj->state;
+    }
+
+    // skip the whole path when nothing style related has changed
+    uint hash = patch.contains("$styleHash") ? (uint)patch.value("$styleHash").toDouble() : styleFingerprint(json);
+    if (hash == obj->styleHash && obj->styleHash != 0) {
+        return;
+    }
+    obj->styleHash = hash;
 
-    QJsonObject style = json.value("style").toObject();
+    QJsonObject style = styleOf(obj, json);
     QJsonObject sheet = json.value("qss").toObject();
 
+    // removed props arrive as null and decode to their defaults
+    uint changed = decodeProps(nodeSchema, patch, obj->props);
+    if (patch.contains("style") || patch.contains("styleId")) {
+        changed |= decodeProps(layoutSchema, style, obj->props, true);
+    }
+
+    // only props used by qss selectors or read back from the widget are
+    // kept as dynamic properties
+    w->setProperty("id", obj->property("id").toString());
+    if (changed & NodeProps::ClassName) {
+        QString className = obj->props.className;
+        if (w->property("hover").toBool()) {
+            className += " hover";
+        }
+        w->setProperty("className", className);
+    }
+    if (changed & NodeProps::Permanent) {
+        w->setProperty("permanent", obj->props.permanent);
+    }
+    if (changed & NodeProps::Row) {
+        w->setProperty("row", obj->props.row);
+    }
+    // qt doesn't match selectors again when a dynamic property changes
+    if ((changed & (NodeProps::ClassName | NodeProps::Permanent | NodeProps::Row)) && obj->engine) {
+        obj->engine->styleCompiler()->polish(w);
+    }
+    // order is applied by the parent's layout pass
+    if ((changed & NodeProps::Order) && obj->engine) {
+        UIObject* parent = obj->engine->findInRegistry("parent", obj->state);
+        if (parent) {
+            obj->engine->scheduleRelayout(parent);
+        }
+    }
+
+    // qDebug() << w->property("className").toString();
+
     // geometry
     if (style.contains("width") || style.contains("height")) {
         w->resize(style.value("width").toInt(), style.value("height").toInt());
@@ -79,38 +266,74 @@ static void applyStyle(QString qtWidgetName, UIObject* obj, QJsonObject json)
         w->setMaximumSize(style.value("maxWidth").toInt(), style.value("maxHeight").toInt());
     }
     if (style.contains("visible")) {
-        w->setVisible(style.value("visible").toBool() == true);
+        bool visible = style.value("visible").toBool() == true;
+        if (visible && !w->parentWidget() && qtWidgetName != "QMainWindow") {
+            // subtrees may be built detached, showing now would open a
+            // top level window. the parent shows it once attached
+            w->setAttribute(Qt::WA_WState_ExplicitShowHide, false);
+        } else {
+            w->setVisible(visible);
+        }
+    }
+
+    // flexbox, views lay out with a FlexLayout and are placed by their
+    // parent's. only the changed layout is invalidated
+    if (changed & NodeProps::Layout) {
+        FlexStyle flex = flexStyleOf(obj->props);
+        FlexLayout* own = qobject_cast<FlexLayout*>(w->layout());
+        if (own) {
+            own->setStyle(flex);
+        }
+        FlexLayout* parent = w->parentWidget() ? qobject_cast<FlexLayout*>(w->parentWidget()->layout()) : NULL;
+        if (parent) {
+            parent->setItemStyle(w, flex);
+        }
     }
 
-    // flexbox
+    // other containers keep a box layout
     QBoxLayout* l = obj->layout();
-    if (l && style.contains("flex-direction")) {
-        if (style.value("flex-direction") == "row") {
+    if (l && (changed & NodeProps::FlexDirection)) {
+        QString direction = obj->props.flexDirection;
+        if (direction == "row") {
             l->setDirection(QBoxLayout::LeftToRight);
         }
-        if (style.value("flex-direction") == "row-reverse") {
+        if (direction == "row-reverse") {
             l->setDirection(QBoxLayout::RightToLeft);
         }
-        if (style.value("flex-direction") == "column") {
+        if (direction == "column") {
             l->setDirection(QBoxLayout::TopToBottom);
         }
-        if (style.value("flex-direction") == "column-reverse") {
+        if (direction == "column-reverse") {
             l->setDirection(QBoxLayout::BottomToTop);
         }
     }
-    w->setProperty("flex", style.value("flex").toInt());
-    w->setProperty("align-items", style.value("align-items").toString());
-    w->setProperty("justify-content", style.value("justify-content").toString());
+
+    QString styleText;
+    if (json.contains("styleId") && obj->engine) {
+        styleText = obj->engine->compiledStyle(json.value("styleId").toInt());
+    } else if (json.contains("$styleText")) {
+        // compiled in the prepare stage
+        styleText = json.value("$styleText").toString();
+    } else if (json.contains("style")) {
+        styleText = toStyle(style);
+    }
+    if (styleText == " {}") {
+        styleText = "";
+    }
+
+    // rules go through the style compiler, shared ones into the
+    // application stylesheet
+    if (obj->engine) {
+        obj->engine->styleCompiler()->setRules(obj, qtWidgetName, styleText, sheet);
+        return;
+    }
 
     QString qss;
 
     // style qss
-    if (json.contains("style") && !qtWidgetName.isEmpty()) {
-        QString styleText = toStyle(style);
-        if (styleText != " {}") {
-            qss += qtWidgetName;
-            qss += styleText;
-        }
+    if (!styleText.isEmpty() && !qtWidgetName.isEmpty()) {
+        qss += qtWidgetName;
+        qss += styleText;
     }
 
     // sheet
@@ -119,8 +342,14 @@ static void applyStyle(QString qtWidgetName, UIObject* obj, QJsonObject json)
     }
 
     if (!qss.isEmpty()) {
-        // qDebug() << qss;
-        w->setStyleSheet(qss);
+        // re-polishing is expensive, only set sheets that differ
+        uint sheet = qHash(qss);
+        if (sheet != obj->sheetHash) {
+            // qDebug() << qss;
+            PROFILE_SCOPE("setStyleSheet");
+            w->setStyleSheet(qss);
+            obj->sheetHash = sheet;
+        }
     }
 }
 
@@ -129,10 +358,136 @@ static void applyStyle(QString qtWidgetName, UIObject* obj, QJsonObject json)
 //----------------------------
 UIFactory::UIFactory(QObject* parent)
     : QObject(parent)
+    , pool(0)
 {
     engine = qobject_cast<Engine*>(parent);
 }
 
+//----------------------------
+// object pool
+//----------------------------
+UIObjectPool::UIObjectPool(int highWater)
+    : defaultHighWater(highWater)
+{
+}
+
+UIObjectPool::Bucket& UIObjectPool::bucket(QString type)
+{
+    if (!buckets.contains(type)) {
+        Bucket b;
+        b.highWater = defaultHighWater;
+        b.hits = 0;
+        b.misses = 0;
+        buckets.insert(type, b);
+    }
+    return buckets[type];
+}
+
+UIObject* UIObjectPool::acquire(QString type)
+{
+    Bucket& b = bucket(type);
+    if (b.objects.isEmpty()) {
+        b.misses++;
+        return NULL;
+    }
+    b.hits++;
+    return b.objects.takeLast();
+}
+
+bool UIObjectPool::release(UIObject* obj)
+{
+    Bucket& b = bucket(obj->metaObject()->className());
+    if (b.objects.size() >= b.highWater) {
+        return false;
+    }
+    b.objects.push_back(obj);
+    return true;
+}
+
+void UIObjectPool::setHighWaterMark(QString type, int count)
+{
+    Bucket& b = bucket(type);
+    b.highWater = count;
+    while (b.objects.size() > count) {
+        b.objects.takeLast()->deleteLater();
+    }
+}
+
+QVariantMap UIObjectPool::stats()
+{
+    QVariantMap res;
+    for (auto it = buckets.begin(); it != buckets.end(); ++it) {
+        QVariantMap b;
+        b.insert("pooled", it.value().objects.size());
+        b.insert("highWater", it.value().highWater);
+        b.insert("hits", it.value().hits);
+        b.insert("misses", it.value().misses);
+        res.insert(it.key(), b);
+    }
+    return res;
+}
+
+UITypeRegistry::UITypeRegistry(UIObjectPool* pool)
+    : pool(pool)
+{
+}
+
+void UITypeRegistry::add(QString type, UIConstructor constructor, int poolSize)
+{
+    constructors.insert(type, constructor);
+    if (pool && poolSize >= 0) {
+        pool->setHighWaterMark(type, poolSize);
+    }
+}
+
+UIObject* UITypeRegistry::create(QString type)
+{
+    auto it = constructors.constFind(type);
+    if (it == constructors.constEnd()) {
+        return NULL;
+    }
+    UIObject* obj = pool ? pool->acquire(type) : NULL;
+    if (!obj) {
+        obj = it.value()();
+    }
+    return obj;
+}
+
+// shared part of UIObject::reset, detaches the widget and clears
+// everything applyStyle and the engine have set on it
+static void resetWidget(UIObject* obj)
+{
+    static const char* props[] = {
+        "id",
+        "className",
+        "permanent",
+        "row",
+        "styleKey",
+        "hover",
+        "mounted"
+    };
+
+    QWidget* w = obj->widget();
+    w->hide();
+    w->setParent(0);
+    // hidden, but not explicitly: layouts show it again once reused
+    w->setAttribute(Qt::WA_WState_ExplicitShowHide, false);
+    w->setStyleSheet("");
+    for (auto p : props) {
+        w->setProperty(p, QVariant());
+    }
+    w->setMinimumSize(0, 0);
+    w->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+
+    obj->handle = 0;
+    obj->styleHash = 0;
+    obj->sheetHash = 0;
+    obj->props = NodeProps();
+    obj->state = QJsonObject();
+    obj->setProperty("id", QVariant());
+    obj->setProperty("persistent", QVariant());
+}
+
 //----------------------------
 // Window
 //----------------------------
@@ -150,6 +505,20 @@ bool Window::update(QJsonObject json)
 {
     applyStyle("QMainWindow", this, json);
     // applyStyle("QWidget", view, json);
+
+    // only the window's container flex props lay out its central view
+    FlexStyle current = flexStyleOf(view->props);
+    view->props.flexDirection = props.flexDirection;
+    view->props.flexWrap = props.flexWrap;
+    view->props.justifyContent = props.justifyContent;
+    view->props.alignItems = props.alignItems;
+    view->props.alignContent = props.alignContent;
+    view->props.gap = props.gap;
+    view->props.rowGap = props.rowGap;
+    view->props.columnGap = props.columnGap;
+    if (flexStyleOf(view->props) != current) {
+        view->relayout();
+    }
     return true;
 }
 
@@ -169,17 +538,27 @@ bool Window::addChild(UIObject* obj)
         return true;
     }
     
+    view->engine = engine;
     view->addChild(obj);
     return true;
 }
 
+bool Window::insertChild(UIObject* obj, UIObject* before)
+{
+    if (qobject_cast<QStatusBar*>(obj->widget()) || qobject_cast<QMenuBar*>(obj->widget())) {
+        return addChild(obj);
+    }
+    view->engine = engine;
+    return view->insertChild(obj, before);
+}
+
 void Window::addToJavaScriptWindowObject()
 {
     QString id = property("id").toString();
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -215,34 +594,43 @@ void TouchableWidget::mouseDoubleClickEvent(QMouseEvent *event)
 
 void TouchableWidget::enterEvent(QEvent *event) {
     if (hoverable) {
-        QString className = property("className").toString();
-        if (!className.contains("hover")) {
-            className += " hover";
-            setProperty("className", className); 
-            QApplication *app = qobject_cast<QApplication*>(QApplication::instance()); 
-            app->style()->unpolish(app);
-            app->style()->polish(app);
-            update();
-        }
+        setHover(true);
     }
     event->ignore();
 }
 
 void TouchableWidget::leaveEvent(QEvent *event) {
     if (hoverable) {
-        QString className = property("className").toString();
-        if (className.contains("hover")) {
-            className.replace(" hover", "");
-            setProperty("className", className);
-            QApplication *app = qobject_cast<QApplication*>(QApplication::instance()); 
-            app->style()->unpolish(app);
-            app->style()->polish(app);
-            update();
-        }
+        setHover(false);
     }
     event->ignore();
 }
 
+void TouchableWidget::setHover(bool hover)
+{
+    if (property("hover").toBool() == hover) {
+        return;
+    }
+
+    QStringList classes = property("className").toString().split(' ', Qt::SkipEmptyParts);
+    classes.removeAll("hover");
+    if (hover) {
+        classes << "hover";
+    }
+    setProperty("className", classes.join(' '));
+    setProperty("hover", hover);
+
+    // hover is a per-widget state, only this subtree is re-polished
+    if (StyleCompiler::hasHoverRules() || !styleSheet().isEmpty()) {
+        style()->unpolish(this);
+        style()->polish(this);
+        for (auto w : findChildren<QWidget*>()) {
+            w->style()->unpolish(w);
+            w->style()->polish(w);
+        }
+    }
+    update();
+}
 
 void TouchableWidget::focusInEvent(QFocusEvent *event)
 {
@@ -258,10 +646,9 @@ void TouchableWidget::focusOutEvent(QFocusEvent *event)
     
 View::View()
     : uiObject(new TouchableWidget)
+    , layoutDirty(false)
 {
-    uiObject->setLayout(new QVBoxLayout());
-    uiObject->layout()->setMargin(0);
-    uiObject->layout()->setSpacing(0);
+    uiObject->setLayout(new FlexLayout());
     connect(uiObject, SIGNAL(pressed()), this, SLOT(onPress()));
     connect(uiObject, SIGNAL(released()), this, SLOT(onRelease()));
 }
@@ -271,26 +658,12 @@ View::~View() { uiObject->deleteLater(); }
 
 void View::onPress()
 {
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
-    }
-    QString value = ""; //
-    QString script = "$widgets[\"" + id + "\"].onPress({ target: { src: \"" + id + "\", value: \"" + value + "\" }})";
-    // qDebug() << script;
-    engine->runScript(script);
+    engine->dispatchEvent(this, "onPress", "");
 }
 
 void View::onRelease()
 {
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
-    }
-    QString value = ""; //
-    QString script = "$widgets[\"" + id + "\"].onRelease({ target: { src: \"" + id + "\", value: \"" + value + "\" }})";
-    // qDebug() << script;
-    engine->runScript(script);
+    engine->dispatchEvent(this, "onRelease", "");
 }
 
 bool View::update(QJsonObject json)
@@ -310,70 +683,98 @@ bool View::update(QJsonObject json)
         uiObject->setFocusPolicy(Qt::NoFocus);
     }
     
-    relayout();
+    requestRelayout();
     return true;
 }
 
 bool View::addChild(UIObject* obj)
 {
-    layout()->addWidget(obj->widget());
-    relayout();
-    return true;
+    return insertChild(obj, NULL);
 };
 
-void View::relayout()
+bool View::insertChild(UIObject* obj, UIObject* before)
 {
-    uiObject->setUpdatesEnabled(false);
+    FlexLayout* l = flexLayout();
+    QWidget* w = obj->widget();
+    if (l->indexOf(w) != -1) {
+        l->removeWidget(w);
+    }
+    int index = before ? l->indexOf(before->widget()) : -1;
+    children.insert(w, obj);
+    l->insertWidget(index, w);
+    l->setItemStyle(w, flexStyleOf(obj->props));
+    requestRelayout();
+    return true;
+}
 
-    QBoxLayout* l = layout();
+bool View::reset()
+{
+    // views still holding live children are not recycled
+    FlexLayout* l = flexLayout();
     for (int i = 0; i < l->count(); ++i) {
-        QLayoutItem* layoutItem = l->itemAt(i);
-        if (layoutItem->spacerItem()) {
-            l->removeItem(layoutItem);
-            delete layoutItem;
-            --i;
-            continue;
-        }
-        QWidget* w = layoutItem->widget();
-        if (w) {
-            int stretch = w->property("flex").toInt();
-            l->setStretch(i, stretch);
+        if (l->itemAt(i)->widget()) {
+            return false;
         }
     }
+    while (l->count()) {
+        delete l->takeAt(0);
+    }
+    l->setStyle(FlexStyle());
 
-    QString align = widget()->property("align-items").toString();
-    QString justify = widget()->property("justify-content").toString();
+    uiObject->hoverable = false;
+    uiObject->touchable = false;
+    uiObject->setFocusPolicy(Qt::NoFocus);
+    layoutDirty = false;
+    children.clear();
+    resetWidget(this);
+    return true;
+}
 
-    // re-order
-    for (int j = 0; j < l->count(); ++j) {
-        for (int i = 0; i < l->count(); ++i) {
-            QLayoutItem* layoutItem = l->itemAt(i);
-            QWidget* w = layoutItem->widget();
-            if (w) {
-                int order = w->property("order").toInt();
-                if (order != -1) {
-                    layout()->insertWidget(order, w);
-                }
-            }
-        }
+void View::requestRelayout()
+{
+    if (!engine) {
+        relayout();
+        return;
     }
-
-    if (justify == "space-around" || justify == "space-between") {
-        int c = l->count() - 1;
-        for (int i = 0; i < c; i++) {
-            l->insertStretch((i * 2) + 1, 1);
-        }
+    if (!layoutDirty) {
+        layoutDirty = true;
+        engine->scheduleRelayout(this);
     }
+}
 
-    if (align == "flex-start" || align == "center" || justify == "center" || justify == "space-around") {
-        l->insertStretch(-1, 1);
-    }
-    if (align == "flex-end" || align == "center" || justify == "center" || justify == "space-around") {
-        l->insertStretch(0, 1);
+UIObject* View::childOf(QWidget* w)
+{
+    // children may have been moved to another parent or recycled since
+    UIObject* obj = w ? children.value(w) : NULL;
+    if (obj && obj->widget() != w) {
+        return NULL;
     }
+    return obj;
+}
+
+void View::relayout()
+{
+    layoutDirty = false;
 
-    uiObject->setUpdatesEnabled(true);
-    uiObject->update();
+    FlexLayout* l = flexLayout();
+    l->setStyle(flexStyleOf(props));
+
+    // re-order, children without an order keep their position. the items
+    // are permuted inside the FlexLayout, widgets are never taken out and
+    // put back, so this replaces the minimal-move (LIS) reorder
+    int n = l->count();
+    QVector<int> keys(n);
+    QVector<int> target(n);
+    for (int i = 0; i < n; ++i) {
+        UIObject* child = childOf(l->itemAt(i)->widget());
+        int order = child ? child->props.order : 0;
+        keys[i] = (order != -1) ? order : i;
+        target[i] = i;
+    }
+    std::stable_sort(target.begin(), target.end(), [&keys](int a, int b) {
+        return keys[a] < keys[b];
+    });
+    l->reorder(target);
 }
 
 void View::addToJavaScriptWindowObject()
@@ -382,7 +783,7 @@ void View::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -419,7 +820,7 @@ void ScrollView::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -461,7 +862,7 @@ void MenuBar::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 
@@ -515,7 +916,7 @@ void Menu::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -558,18 +959,12 @@ void MenuItem::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 void MenuItem::onTrigger(bool checked)
 {
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
-    }
-    QString script = "$widgets[\"" + id + "\"].onClick({ target: { src: \"" + id + "\", value: " + (checked ? "true" : "false") + " }})";
-    // qDebug() << script;
-    engine->runScript(script);
+    engine->dispatchEvent(this, "onClick", checked);
 }
 
 //----------------------------
@@ -621,7 +1016,7 @@ void StatusBar::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 void StatusBar::showMessage(QString msg, int timeout)
@@ -663,13 +1058,24 @@ bool SplitterView::addChild(UIObject* obj)
     return true;
 };
 
+bool SplitterView::insertChild(UIObject* obj, UIObject* before)
+{
+    // insertWidget moves a pane the splitter already holds
+    int index = before ? uiObject->indexOf(before->widget()) : -1;
+    if (index != -1 && uiObject->indexOf(obj->widget()) != -1 && uiObject->indexOf(obj->widget()) < index) {
+        index--;
+    }
+    uiObject->insertWidget(index, obj->widget());
+    return true;
+}
+
 void SplitterView::addToJavaScriptWindowObject()
 {
     QString id = property("id").toString();
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -677,7 +1083,13 @@ void SplitterView::addToJavaScriptWindowObject()
 //----------------------------
 StackedView::StackedView()
     : uiObject(new QStackedWidget)
+    , lazy(true)
+    , current(0)
+    , releaseAfter(0)
+    , releaseTimer(this)
 {
+    clock.start();
+    connect(&releaseTimer, SIGNAL(timeout()), this, SLOT(releasePages()));
 }
 
 StackedView::~StackedView() { uiObject->deleteLater(); }
@@ -686,9 +1098,29 @@ bool StackedView::update(QJsonObject json)
 {
     applyStyle("QStackedWidget", this, json);
 
+    if (json.contains("lazy")) {
+        lazy = json.value("lazy").toBool();
+    }
+
+    if (json.contains("releaseAfter")) {
+        releaseAfter = json.value("releaseAfter").toInt();
+        if (releaseAfter > 0) {
+            releaseTimer.start(releaseAfter);
+        } else {
+            releaseTimer.stop();
+        }
+    }
+
     if (json.contains("current")) {
-        QString current = json.value("current").toString();
-        UIObject *obj = engine->findInRegistryById(current);
+        // pages are addressed by handle or alias
+        currentAlias = json.value("current").toString();
+        int handle = engine->handleOf(json.value("current"));
+        UIObject *obj = engine->materialize(handle);
+        if (current && current != handle) {
+            hiddenSince.insert(current, clock.elapsed());
+        }
+        current = handle;
+        hiddenSince.remove(current);
         if (obj) {
             uiObject->setCurrentWidget(obj->widget());
         }
@@ -699,16 +1131,51 @@ bool StackedView::update(QJsonObject json)
 bool StackedView::addChild(UIObject* obj)
 {
     uiObject->addWidget(obj->widget());
+    if (obj->handle == current) {
+        uiObject->setCurrentWidget(obj->widget());
+    } else if (!hiddenSince.contains(obj->handle)) {
+        hiddenSince.insert(obj->handle, clock.elapsed());
+    }
     return true;
 };
 
+UIObject::ChildMount StackedView::childMount(QJsonObject json)
+{
+    if (!lazy) {
+        return MountNow;
+    }
+    int handle = json.value("id").toInt();
+    if (!currentAlias.isEmpty() && json.value("alias").toString() == currentAlias) {
+        // current was set by alias before the page was mounted
+        current = handle;
+    }
+    if (handle == current || (!current && !uiObject->count())) {
+        // the page on screen, or the first one when current is not set
+        return MountTracked;
+    }
+    return MountDeferred;
+}
+
+void StackedView::releasePages()
+{
+    qint64 now = clock.elapsed();
+    for (auto it = hiddenSince.begin(); it != hiddenSince.end();) {
+        if (it.key() != current && now - it.value() >= releaseAfter && engine->isMaterialized(it.key())) {
+            engine->release(it.key());
+            it = hiddenSince.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
 void StackedView::addToJavaScriptWindowObject()
 {
     QString id = property("id").toString();
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -726,25 +1193,34 @@ Text::~Text() { uiObject->deleteLater(); }
 
 bool Text::update(QJsonObject json)
 {
-    if (json.contains("text")) {
-        QString newText = json.value("text").toString();
-        if (newText != uiObject->text()) {
-            uiObject->setText(newText);
+    uint changed = decodeProps(textSchema, json, textProps);
+    // text wins over renderedText while the retained props have it
+    if (state.contains("text")) {
+        if (changed & TextProps::Text) {
+            uiObject->setText(textProps.text);
         }
-    } else if (json.contains("renderedText")) {
-        uiObject->setText(json.value("renderedText").toString());
+    } else if (changed & (TextProps::Text | TextProps::RenderedText)) {
+        uiObject->setText(textProps.renderedText);
     }
     applyStyle("QLabel", this, json);
     return true;
 }
 
+bool Text::reset()
+{
+    uiObject->clear();
+    textProps = TextProps();
+    resetWidget(this);
+    return true;
+}
+
 void Text::addToJavaScriptWindowObject()
 {
     QString id = property("id").toString();
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -752,6 +1228,7 @@ void Text::addToJavaScriptWindowObject()
 //----------------------------
 TextInput::TextInput()
     : uiObject(new QLineEdit)
+    , editBatch(0)
 {
     uiObject->setLayout(new QVBoxLayout());
     connect(uiObject, SIGNAL(textEdited(QString)), this, SLOT(onChange(QString)));
@@ -763,33 +1240,45 @@ TextInput::~TextInput() { uiObject->deleteLater(); }
 bool TextInput::update(QJsonObject json)
 {
     applyStyle("QLineEdit", this, json);
-    if (json.contains("text")) {
-        QString newText = json.value("text").toString();
-        if (newText != uiObject->text()) {
-            uiObject->setText(newText);
-        }
+    uint changed = decodeProps(textInputSchema, json, inputProps);
+    // typing changes the widget behind the decoded value, compare both
+    if (json.contains("text") && inputProps.text != uiObject->text()) {
+        uiObject->setText(inputProps.text);
     }
-    if (json.contains("placeholder")) {
-        QString placeholder = json.value("placeholder").toString();
-        if (placeholder != uiObject->placeholderText()) {
-            uiObject->setPlaceholderText(placeholder);
-        }
+    if (changed & TextInputProps::Placeholder) {
+        uiObject->setPlaceholderText(inputProps.placeholder);
     }
     return true;
 }
 
 void TextInput::onChange(QString value)
-{    
+{
     if (!uiObject->isVisible()) {
         return;
     }
-    
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
+    engine->dispatchEvent(this, "onChangeText", value);
+    if (state.contains("text")) {
+        // checked once JS has replied to this edit
+        editBatch = engine->nextEventBatch();
+        connect(engine, SIGNAL(committed(int)), this, SLOT(restoreText(int)), Qt::UniqueConnection);
+    }
+}
+
+void TextInput::restoreText(int batch)
+{
+    // a controlled input whose handler rejected or normalized the edit
+    // sends no patch, its retained text is put back instead
+    if (batch < editBatch) {
+        return;
+    }
+    disconnect(engine, SIGNAL(committed(int)), this, SLOT(restoreText(int)));
+    if (!state.contains("text")) {
         return;
     }
-    QString script = "$widgets[\"" + id + "\"].onChangeText({ target: { src: \"" + id + "\", value: \"" + value.replace('\\', "\\\\") + "\" }})";
-    engine->runScript(script);
+    QString text = state.value("text").toString();
+    if (text != uiObject->text()) {
+        uiObject->setText(text);
+    }
 }
 
 void TextInput::onSubmit()
@@ -797,13 +1286,20 @@ void TextInput::onSubmit()
     if (!uiObject->isVisible()) {
         return;
     }
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
+    engine->dispatchEvent(this, "onSubmitEditing", "");
+}
+
+bool TextInput::reset()
+{
+    uiObject->clear();
+    uiObject->setPlaceholderText("");
+    inputProps = TextInputProps();
+    if (engine) {
+        disconnect(engine, SIGNAL(committed(int)), this, SLOT(restoreText(int)));
     }
-    QString value = ""; //
-    QString script = "$widgets[\"" + id + "\"].onSubmitEditing({ target: { src: \"" + id + "\", value: \"" + value + "\" }})";
-    engine->runScript(script);
+    editBatch = 0;
+    resetWidget(this);
+    return true;
 }
 
 void TextInput::addToJavaScriptWindowObject()
@@ -812,7 +1308,7 @@ void TextInput::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 void TextInput::focus()
@@ -830,6 +1326,236 @@ void TextInput::setText(QString text)
     uiObject->setText(text);
 }
 
+//----------------------------
+// ListView
+//----------------------------
+ListModel::ListModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , count(0)
+    , rowHeight(32)
+{
+}
+
+int ListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return count;
+}
+
+QVariant ListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= count) {
+        return QVariant();
+    }
+    if (role == Qt::SizeHintRole) {
+        return QSize(1, rowHeight);
+    }
+    // rows are painted by recycled row widgets
+    return QVariant();
+}
+
+void ListModel::setCount(int rows)
+{
+    if (rows == count) {
+        return;
+    }
+    beginResetModel();
+    count = rows;
+    endResetModel();
+}
+
+void ListModel::setRowHeight(int height)
+{
+    if (height == rowHeight || height <= 0) {
+        return;
+    }
+    beginResetModel();
+    rowHeight = height;
+    endResetModel();
+}
+
+RecyclerView::RecyclerView()
+    : QListView()
+{
+    setUniformItemSizes(true);
+    setSelectionMode(QAbstractItemView::NoSelection);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+}
+
+void RecyclerView::scrollContentsBy(int dx, int dy)
+{
+    QListView::scrollContentsBy(dx, dy);
+    emit viewportChanged();
+}
+
+void RecyclerView::resizeEvent(QResizeEvent *event)
+{
+    QListView::resizeEvent(event);
+    emit viewportChanged();
+}
+
+ListView::ListView()
+    : uiObject(new RecyclerView)
+    , model(new ListModel(this))
+    , overscan(4)
+    , firstVisible(-1)
+    , lastVisible(-1)
+    , layoutDirty(false)
+    , fixedRowHeight(false)
+    , rowHeightMeasured(false)
+{
+    uiObject->setModel(model);
+    connect(uiObject, SIGNAL(viewportChanged()), this, SLOT(onViewportChanged()));
+}
+
+ListView::~ListView() { uiObject->deleteLater(); }
+
+bool ListView::update(QJsonObject json)
+{
+    applyStyle("QListView", this, json);
+    if (json.contains("rowHeight")) {
+        // without one the height is estimated from the first rows
+        int height = json.value("rowHeight").toInt();
+        fixedRowHeight = height > 0;
+        rowHeightMeasured = false;
+        model->setRowHeight(fixedRowHeight ? height : 32);
+    }
+    if (json.contains("overscan")) {
+        overscan = json.value("overscan").toInt();
+    }
+    // the rows themselves are rendered by JS, only their count is needed
+    if (json.contains("count")) {
+        model->setCount(json.value("count").toInt());
+    }
+    requestRelayout();
+    return true;
+}
+
+bool ListView::addChild(UIObject* obj)
+{
+    // children are row widgets, placed over the row given by their row prop
+    QWidget* w = obj->widget();
+    w->setParent(uiObject->viewport());
+    w->installEventFilter(this);
+    rows << w;
+    requestRelayout();
+    return true;
+}
+
+bool ListView::eventFilter(QObject* obj, QEvent* event)
+{
+    if (event->type() == QEvent::DynamicPropertyChange) {
+        QDynamicPropertyChangeEvent* change = static_cast<QDynamicPropertyChangeEvent*>(event);
+        if (change->propertyName() == "row" || change->propertyName() == "mounted") {
+            requestRelayout();
+        }
+    }
+    return UIObject::eventFilter(obj, event);
+}
+
+void ListView::requestRelayout()
+{
+    if (!engine) {
+        relayout();
+        return;
+    }
+    if (!layoutDirty) {
+        layoutDirty = true;
+        engine->scheduleRelayout(this);
+    }
+}
+
+void ListView::relayout()
+{
+    layoutDirty = false;
+
+    int width = uiObject->viewport()->width();
+    int count = model->rowCount();
+    for (int i = 0; i < rows.size(); i++) {
+        QWidget* w = rows[i];
+        if (!w || w->parent() != uiObject->viewport()) {
+            if (w) {
+                w->removeEventFilter(this);
+            }
+            rows.removeAt(i--);
+        }
+    }
+
+    if (!fixedRowHeight && !rowHeightMeasured) {
+        // rows share one height, estimated once from the tallest of the
+        // first rows rendered
+        int height = 0;
+        for (auto w : rows) {
+            if (w->property("mounted").toBool()) {
+                w->ensurePolished();
+                height = qMax(height, w->hasHeightForWidth() ? w->heightForWidth(width) : w->sizeHint().height());
+            }
+        }
+        if (height > 0) {
+            rowHeightMeasured = true;
+            model->setRowHeight(height);
+        }
+    }
+
+    for (auto w : rows) {
+        int row = w->property("row").toInt();
+        if (!w->property("mounted").toBool() || row < 0 || row >= count) {
+            w->hide();
+            continue;
+        }
+        QRect rect = uiObject->visualRect(model->index(row, 0));
+        w->setGeometry(0, rect.top(), width, rect.height());
+        w->show();
+    }
+
+    updateRange();
+}
+
+void ListView::updateRange()
+{
+    int count = model->rowCount();
+    int height = uiObject->viewport()->height();
+    if (!engine || height <= 0) {
+        return;
+    }
+    QModelIndex top = uiObject->indexAt(QPoint(0, 0));
+    QModelIndex bottom = uiObject->indexAt(QPoint(0, height - 1));
+    int first = top.isValid() ? top.row() : 0;
+    int last = bottom.isValid() ? bottom.row() : count - 1;
+    first = qMax(0, first - overscan);
+    last = qMin(count - 1, last + overscan);
+
+    if (first == firstVisible && last == lastVisible) {
+        return;
+    }
+    firstVisible = first;
+    lastVisible = last;
+
+    // JS renders only the rows in this range
+    QVariantMap range;
+    range.insert("first", first);
+    range.insert("last", last);
+    engine->dispatchEvent(this, "onRangeChanged", range);
+}
+
+void ListView::onViewportChanged()
+{
+    // scrolling is not driven by a render, reposition rows right away
+    relayout();
+}
+
+void ListView::addToJavaScriptWindowObject()
+{
+    QString id = property("id").toString();
+    if (id.isEmpty()) {
+        return;
+    }
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+}
+
 //----------------------------
 // Image
 //----------------------------
@@ -839,8 +1565,13 @@ Image::Image()
     uiObject->setLayout(new QVBoxLayout());
     uiObject->setTextFormat(Qt::RichText);
     uiObject->setTextInteractionFlags(Qt::NoTextInteraction);
-    netman = new QNetworkAccessManager(this);
-    connect(netman, SIGNAL(finished(QNetworkReply*)), this, SLOT(replyFinished(QNetworkReply*)));
+    uiObject->setAlignment(Qt::AlignCenter);
+    uiObject->installEventFilter(this);
+
+    // re-rasterize once the layout has settled
+    resizeTimer.setSingleShot(true);
+    resizeTimer.setInterval(100);
+    connect(&resizeTimer, SIGNAL(timeout()), this, SLOT(requestImage()));
 }
 
 Image::~Image() { uiObject->deleteLater(); }
@@ -848,12 +1579,12 @@ Image::~Image() { uiObject->deleteLater(); }
 bool Image::update(QJsonObject json)
 {
     applyStyle("QLabel", this, json);
-    if (json.contains("source")) {
+    if ((decodeProps(imageSchema, json, imageProps) & ImageProps::Source) && !imageProps.source.isEmpty()) {
         // if (engine->basePath.scheme() == "http") {
-        QString imageSource = engine->basePath.toString() + json.value("source").toString();
+        QString imageSource = engine->basePath.toString() + imageProps.source;
         if (lastSource != imageSource) {
-            netman->get(QNetworkRequest(QUrl(imageSource)));
             lastSource = imageSource;
+            requestImage();
         }
     }
     // qDebug() << "image";
@@ -862,18 +1593,43 @@ bool Image::update(QJsonObject json)
     return true;
 }
 
-void Image::replyFinished(QNetworkReply* reply)
+bool Image::eventFilter(QObject* obj, QEvent* event)
 {
-    if (reply->error()) {
-        qDebug() << reply->errorString();
-    } else {
-        int w = uiObject->width();
-        int h = uiObject->height();
-        QImageReader imageReader(reply);
-        imageReader.setAutoDetectImageFormat(true);
-        image = imageReader.read();
-        uiObject->setPixmap(QPixmap::fromImage(image).scaled(w, h, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    if (event->type() == QEvent::Resize && !lastSource.isEmpty()) {
+        resizeTimer.start();
+    }
+    return UIObject::eventFilter(obj, event);
+}
+
+void Image::requestImage()
+{
+    if (lastSource.isEmpty()) {
+        return;
+    }
+    QUrl url(lastSource);
+    QSize size = uiObject->size();
+    QString key = ImageLoader::key(url, size);
+    if (key == pendingKey) {
+        return;
+    }
+    QPixmap pixmap;
+    pendingKey = key;
+    if (engine->imageLoader()->load(url, size, this, &pixmap)) {
+        setImage(pendingKey, pixmap);
+    }
+}
+
+void Image::setImage(QString key, QPixmap pixmap)
+{
+    if (key != pendingKey) {
+        return;
+    }
+    if (pixmap.isNull()) {
+        // failed, the same source is tried again on the next load
+        pendingKey.clear();
+        return;
     }
+    uiObject->setPixmap(pixmap);
 }
 
 void Image::addToJavaScriptWindowObject()
@@ -882,7 +1638,7 @@ void Image::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
@@ -902,23 +1658,22 @@ Button::~Button() { uiObject->deleteLater(); }
 bool Button::update(QJsonObject json)
 {
     applyStyle("QPushButton", this, json);
-    if (json.contains("text")) {
-        QString newText = json.value("text").toString();
-        if (newText != uiObject->text()) {
-            uiObject->setText(newText);
-        }
+    uint changed = decodeProps(buttonSchema, json, buttonProps);
+    if (changed & ButtonProps::Text) {
+        uiObject->setText(buttonProps.text);
     }
-    if (json.contains("checked")) {
-        uiObject->setChecked(json.value("checked").toBool());
+    if (changed & ButtonProps::Checkable) {
+        uiObject->setCheckable(buttonProps.checkable);
     }
-    if (json.contains("checkable")) {
-        uiObject->setCheckable(json.value("checkable").toBool());
+    if (json.contains("checked")) {
+        // clicks toggle the widget behind the decoded value
+        uiObject->setChecked(buttonProps.checked);
     }
-    if (json.contains("icon")) {
-        uiObject->setIcon(engine->icon(json.value("icon").toString()));
+    if (changed & ButtonProps::Icon) {
+        uiObject->setIcon(engine->icon(buttonProps.icon));
     }
-    if (json.contains("style")) {
-        QJsonObject style = json.value("style").toObject();
+    if (json.contains("style") || json.contains("styleId")) {
+        QJsonObject style = styleOf(this, json);
         if (style.contains("icon-width") && style.contains("icon-height")) {
             QSize sz(style.value("icon-width").toInt(), style.value("icon-height").toInt());
             uiObject->setIconSize(sz);
@@ -929,37 +1684,28 @@ bool Button::update(QJsonObject json)
 
 void Button::onClick(bool checked)
 {
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
-    }
-    QString script = "$widgets[\"" + id + "\"].onClick({ target: { src: \"" + id + "\", value: " + (checked ? "true" : "false") + " }})";
-    // qDebug() << script;
-    engine->runScript(script);
+    engine->dispatchEvent(this, "onClick", checked);
 }
 
 void Button::onPress()
 {
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
-    }
-    QString value = ""; //
-    QString script = "$widgets[\"" + id + "\"].onPress({ target: { src: \"" + id + "\", value: \"" + value + "\" }})";
-    // qDebug() << script;
-    engine->runScript(script);
+    engine->dispatchEvent(this, "onPress", "");
 }
 
 void Button::onRelease()
 {
-    QString id = property("id").toString();
-    if (id.isEmpty()) {
-        return;
-    }
-    QString value = ""; //
-    QString script = "$widgets[\"" + id + "\"].onRelease({ target: { src: \"" + id + "\", value: \"" + value + "\" }})";
-    // qDebug() << script;
-    engine->runScript(script);
+    engine->dispatchEvent(this, "onRelease", "");
+}
+
+bool Button::reset()
+{
+    uiObject->setText("");
+    uiObject->setIcon(QIcon());
+    uiObject->setChecked(false);
+    uiObject->setCheckable(false);
+    buttonProps = ButtonProps();
+    resetWidget(this);
+    return true;
 }
 
 void Button::addToJavaScriptWindowObject()
@@ -968,58 +1714,48 @@ void Button::addToJavaScriptWindowObject()
     if (id.isEmpty()) {
         return;
     }
-    engine->frame->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
+    engine->addToJavaScriptWindowObject("$widgets_" + id.replace(':','_'), this);
 }
 
 //----------------------------
 // Core factory
 //----------------------------
-UIObject* UICoreFactory::create(QJsonObject json)
+static UIObject* createWindow()
 {
-    QString type = json.value("type").toString();
-
-    // qDebug() << json;
-    // qDebug() << "create" << type;
-
-    BEGIN_UI_DEF(Window)
-    uiObject->widget()->show();
-    END_UI()
-
-    BEGIN_UI_DEF(View)
-    END_UI()
-
-    BEGIN_UI_DEF(Image)
-    END_UI()
-
-    BEGIN_UI_DEF(ScrollView)
-    END_UI()
-
-    BEGIN_UI_DEF(SplitterView)
-    END_UI()
-
-    BEGIN_UI_DEF(StackedView)
-    END_UI()
-
-    BEGIN_UI_DEF(Text)
-    END_UI()
+    Window* window = new Window();
+    window->widget()->show();
+    return window;
+}
 
-    BEGIN_UI_DEF(TextInput)
-    END_UI()
+void UICoreFactory::registerTypes(UITypeRegistry* registry)
+{
+    registry->add("Window", createWindow, 0);
+    registry->add("View", constructUI<View>);
+    registry->add("Image", constructUI<Image>);
+    registry->add("ScrollView", constructUI<ScrollView>);
+    registry->add("ListView", constructUI<ListView>);
+    registry->add("SplitterView", constructUI<SplitterView>);
+    registry->add("StackedView", constructUI<StackedView>);
+    registry->add("Text", constructUI<Text>);
+    registry->add("TextInput", constructUI<TextInput>);
+    registry->add("Button", constructUI<Button>);
+    registry->add("StatusBar", constructUI<StatusBar>);
+    registry->add("MenuBar", constructUI<MenuBar>);
+    registry->add("Menu", constructUI<Menu>);
+    registry->add("MenuItem", constructUI<MenuItem>);
+}
 
-    BEGIN_UI_DEF(Button)
-    END_UI()
-    
-    BEGIN_UI_DEF(StatusBar)
-    END_UI()
-    
-    BEGIN_UI_DEF(MenuBar)
-    END_UI()
-        
-    BEGIN_UI_DEF(Menu)
-    END_UI()
-        
-    BEGIN_UI_DEF(MenuItem)
-    END_UI()
-
-    return NULL;
+UIObject* UICoreFactory::create(QJsonObject json)
+{
+    // the types of registerTypes, for callers using the factory directly
+    static UITypeRegistry types;
+    if (types.types().isEmpty()) {
+        registerTypes(&types);
+    }
+    QString type = json.value("type").toString();
+    if (!types.contains(type)) {
+        return NULL;
+    }
+    UIObject* obj = acquire(type);
+    return obj ? obj : types.create(type);
 }
@@ -22,16 +22,31 @@
 #include <QMenu>
 #include <QAction>
 #include <QStackedWidget>
-
-#define BEGIN_UI_DEF(T) \
-    if (type == #T) {   \
-        T* uiObject = new T();
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QAbstractListModel>
+#include <QJsonArray>
+#include <QListView>
+#include <QPointer>
+
+#include "props.h"
+
+#define BEGIN_UI_DEF(T)                              \
+    if (type == #T) {                                \
+        T* uiObject = qobject_cast<T*>(acquire(#T)); \
+        if (!uiObject) {                             \
+            uiObject = new T();                      \
+        }
 
 #define END_UI()     \
     return uiObject; \
     }
 
 QJsonObject toJson(QString json);
+QString toStyle(QJsonObject json);
+QString toQss(QJsonObject json);
+uint styleFingerprint(QJsonObject json);
 
 class Engine;
 class View;
@@ -42,6 +57,14 @@ class QNetworkReply;
 class UIObject : public QObject {
     Q_OBJECT
 public:
+    UIObject()
+        : engine(0)
+        , handle(0)
+        , styleHash(0)
+        , sheetHash(0)
+    {
+    }
+
     virtual bool mount(QJsonObject json) = 0;
     virtual bool update(QJsonObject json) = 0;
     virtual bool unmount() = 0;
@@ -51,7 +74,47 @@ public:
     virtual QBoxLayout* layout() = 0;
     virtual void addToJavaScriptWindowObject() = 0;
 
+    // places a child ahead of another one, before may be NULL to append.
+    // containers that keep their children in order override this, others
+    // ignore moves of children they already hold
+    virtual bool insertChild(UIObject* obj, UIObject* before)
+    {
+        if (widget() && obj->widget() && widget()->isAncestorOf(obj->widget())) {
+            return true;
+        }
+        return addChild(obj);
+    }
+
+    // deferred layout pass, run by the engine once per render tick
+    virtual void relayout() {}
+
+    // restores a pristine state so the object can be pooled and reused,
+    // returns false for objects that cannot be recycled
+    virtual bool reset() { return false; }
+
+    // how the engine mounts a child of this object. tracked children keep
+    // their props as a descriptor so they can be released and rebuilt,
+    // deferred ones are only created when materialized
+    enum ChildMount {
+        MountNow,
+        MountTracked,
+        MountDeferred
+    };
+    virtual ChildMount childMount(QJsonObject json) { return MountNow; }
+
     Engine* engine;
+    int handle;
+
+    // fingerprints of the last applied style props and stylesheet
+    uint styleHash;
+    uint sheetHash;
+
+    // decoded by applyStyle, read by the parent's layout pass
+    NodeProps props;
+
+    // every prop received so far with update patches merged in, kept by
+    // the engine; update() itself only gets the patch
+    QJsonObject state;
 };
 
 class Window : public UIObject {
@@ -68,6 +131,7 @@ public:
         return true;
     };
     bool addChild(UIObject* obj) override;
+    bool insertChild(UIObject* obj, UIObject* before) override;
 
     QWidget* widget() { return uiObject; }
     void setWidget(QWidget *w) override {};
@@ -89,6 +153,9 @@ class TouchableWidget : public QFrame
     Q_OBJECT
 public:
     TouchableWidget();
+
+    void setHover(bool hover);
+
 private:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
@@ -122,20 +189,27 @@ public:
         return true;
     };
     bool addChild(UIObject* obj) override;
+    bool insertChild(UIObject* obj, UIObject* before) override;
 
     QWidget* widget() { return uiObject; }
     void setWidget(QWidget *w) override {};
-    QBoxLayout* layout()
-    {
-        return qobject_cast<QBoxLayout*>(uiObject->layout());
-    }
+
+    // no box layout, children are placed by flexLayout()
+    QBoxLayout* layout() { return 0; }
 
     void addToJavaScriptWindowObject() override;
+    bool reset() override;
+
+    void relayout() override;
 
 private:
-    void relayout();
+    FlexLayout* flexLayout() { return qobject_cast<FlexLayout*>(uiObject->layout()); }
+    void requestRelayout();
+    UIObject* childOf(QWidget* w);
 
     TouchableWidget* uiObject;
+    bool layoutDirty;
+    QHash<QWidget*, QPointer<UIObject>> children;
 
 public Q_SLOTS:
     void onPress();
@@ -193,7 +267,7 @@ public:
     void addToJavaScriptWindowObject() override;
 
 private:
-    void relayout();
+    void relayout() override;
     
     QStatusBar* uiObject;
     
@@ -310,6 +384,7 @@ public:
         return true;
     };
     bool addChild(UIObject* obj) override;
+    bool insertChild(UIObject* obj, UIObject* before) override;
 
     QWidget* widget() { return uiObject; }
     void setWidget(QWidget *w) override {};
@@ -339,6 +414,11 @@ public:
     };
     bool addChild(UIObject* obj) override;
 
+    // pages other than the current one are created when first shown
+    // (lazy, on by default). with releaseAfter set, pages hidden for
+    // that many ms are released back to descriptors.
+    ChildMount childMount(QJsonObject json) override;
+
     QWidget* widget() { return uiObject; }
     void setWidget(QWidget *w) override {};
     QBoxLayout* layout()
@@ -348,8 +428,18 @@ public:
 
     void addToJavaScriptWindowObject() override;
 
+private slots:
+    void releasePages();
+
 private:
     QStackedWidget* uiObject;
+    bool lazy;
+    int current;
+    QString currentAlias;
+    int releaseAfter;
+    QHash<int, qint64> hiddenSince;
+    QElapsedTimer clock;
+    QTimer releaseTimer;
 };
 
 class Text : public UIObject {
@@ -379,9 +469,11 @@ public:
     }
 
     void addToJavaScriptWindowObject() override;
+    bool reset() override;
 
 private:
     QLabel* uiObject;
+    TextProps textProps;
 };
 
 class TextInput : public UIObject {
@@ -411,6 +503,7 @@ public:
     }
 
     void addToJavaScriptWindowObject() override;
+    bool reset() override;
 
 public Q_SLOTS:
     
@@ -420,10 +513,90 @@ public Q_SLOTS:
 
 private:
     QLineEdit* uiObject;
+    TextInputProps inputProps;
+    int editBatch;
 
 private Q_SLOTS:
     void onChange(QString val);
     void onSubmit();
+    void restoreText(int batch);
+};
+
+class ListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    ListModel(QObject* parent = 0);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void setCount(int count);
+    void setRowHeight(int height);
+
+private:
+    int count;
+    int rowHeight;
+};
+
+class RecyclerView : public QListView
+{
+    Q_OBJECT
+public:
+    RecyclerView();
+
+protected:
+    void scrollContentsBy(int dx, int dy) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+signals:
+    void viewportChanged();
+};
+
+class ListView : public UIObject {
+    Q_OBJECT
+public:
+    ListView();
+    ~ListView();
+
+    bool update(QJsonObject json) override;
+    bool mount(QJsonObject json) override { return true; };
+    bool unmount() override
+    {
+        this->deleteLater();
+        return true;
+    };
+    bool addChild(UIObject* obj) override;
+
+    QWidget* widget() { return uiObject; }
+    void setWidget(QWidget *w) override {};
+    QBoxLayout* layout()
+    {
+        return qobject_cast<QBoxLayout*>(uiObject->layout());
+    }
+
+    void addToJavaScriptWindowObject() override;
+
+    void relayout() override;
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event) override;
+
+private:
+    void requestRelayout();
+    void updateRange();
+
+    RecyclerView* uiObject;
+    ListModel* model;
+    QList<QPointer<QWidget>> rows;
+    int overscan;
+    int firstVisible;
+    int lastVisible;
+    bool layoutDirty;
+    bool fixedRowHeight;
+    bool rowHeightMeasured;
+
+private Q_SLOTS:
+    void onViewportChanged();
 };
 
 class Image : public UIObject {
@@ -454,14 +627,21 @@ public:
 
     void addToJavaScriptWindowObject() override;
 
-private Q_SLOTS:
-    void replyFinished(QNetworkReply* reply);
+public Q_SLOTS:
+    void setImage(QString key, QPixmap pixmap);
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event) override;
 
 private:
     QLabel* uiObject;
-    QNetworkAccessManager* netman;
+    ImageProps imageProps;
     QString lastSource;
-    QImage image;
+    QString pendingKey;
+    QTimer resizeTimer;
+
+private Q_SLOTS:
+    void requestImage();
 };
 
 class Button : public UIObject {
@@ -491,9 +671,11 @@ public:
     }
 
     void addToJavaScriptWindowObject() override;
+    bool reset() override;
     
 private:
     QPushButton* uiObject;
+    ButtonProps buttonProps;
 
 private Q_SLOTS:
     void onClick(bool checked);
@@ -501,10 +683,66 @@ private Q_SLOTS:
     void onRelease();
 };
 
+// Bounded per-type pool of unmounted objects, the factory draws from it
+// before allocating new objects and widgets
+class UIObjectPool {
+public:
+    UIObjectPool(int highWater = 64);
+
+    UIObject* acquire(QString type);
+    bool release(UIObject* obj);
+
+    void setHighWaterMark(QString type, int count);
+    QVariantMap stats();
+
+private:
+    struct Bucket {
+        QList<UIObject*> objects;
+        int highWater;
+        int hits;
+        int misses;
+    };
+
+    Bucket& bucket(QString type);
+
+    QHash<QString, Bucket> buckets;
+    int defaultHighWater;
+};
+
+typedef UIObject* (*UIConstructor)();
+
+template <class T>
+UIObject* constructUI() { return new T(); }
+
+// Maps type names to constructors, one hash lookup per mount. Factories
+// register their types through UIFactory::registerTypes; a type may
+// also set the size of its pool.
+class UITypeRegistry {
+public:
+    UITypeRegistry(UIObjectPool* pool = 0);
+
+    void add(QString type, UIConstructor constructor, int poolSize = -1);
+    bool contains(QString type) const { return constructors.contains(type); }
+    QStringList types() const { return constructors.keys(); }
+
+    // a pooled object when one is available, NULL for unknown types
+    UIObject* create(QString type);
+
+private:
+    QHash<QString, UIConstructor> constructors;
+    UIObjectPool* pool;
+};
+
 class UIFactory : public QObject {
 public:
     UIFactory(QObject* engine = 0);
 
+    void setPool(UIObjectPool* pool) { this->pool = pool; }
+
+    // types added here skip create(), which stays as the fallback for
+    // factories that only implement the BEGIN_UI_DEF chain
+    virtual void registerTypes(UITypeRegistry* registry) {}
+
     virtual UIObject* create(QString jsonString)
     {
         QByteArray bytes;
@@ -516,11 +754,16 @@ public:
     
     virtual UIObject* create(QJsonObject json) { return NULL; }
 
+protected:
+    UIObject* acquire(QString type) { return pool ? pool->acquire(type) : NULL; }
+
 private:
     Engine* engine;
+    UIObjectPool* pool;
 };
 
 class UICoreFactory : public UIFactory {
 public:
+    void registerTypes(UITypeRegistry* registry) override;
     UIObject* create(QJsonObject json) override;
 };
\ No newline at end of file
@@ -1,18 +1,47 @@
 #include <QDebug>
 #include <QFile>
+#include <QJsonArray>
+#include <QGuiApplication>
 #include <QJsonDocument>
+#include <QScreen>
 #include <QSplitter>
 #include <QVBoxLayout>
 
 #include "core.h"
 #include "engine.h"
+#include "images.h"
+#include "prepare.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "style.h"
 
-#define UPDATE_FREQ 50
+#define MIN_FRAME_INTERVAL 16
+#define MAX_FRAME_INTERVAL 250
 
 Engine::Engine(QWidget* parent)
     : QWidget(parent)
     , updateTimer(this)
+    , minFrameInterval(MIN_FRAME_INTERVAL)
+    , maxFrameInterval(MAX_FRAME_INTERVAL)
+    , frameBudget(0)
+    , progressiveAttach(false)
+    , nextHandle(1)
+    , pool(new UIObjectPool())
+    , types(new UITypeRegistry(pool))
+    , images(new ImageLoader(this))
+    , compiler(new StyleCompiler(this))
+    , preparer(new Preparer(this))
+    , droppedUpdates(0)
+    , recorder(0)
+    , awaitingReply(false)
+    , eventsSent(0)
+    , eventBatches(0)
+    , replyTo(0)
+    , replyCall(0)
+    , relayoutCount(0)
+    , overlay(0)
 {
+#ifndef JQN_HEADLESS
     QSplitter* splitter = new QSplitter(Qt::Vertical, this);
 
     QVBoxLayout* box = new QVBoxLayout(this);
@@ -39,19 +68,170 @@ Engine::Engine(QWidget* parent)
     box->setSpacing(0);
     splitter->addWidget(view);
     splitter->addWidget(inspector);
+#endif
 
+    // cap renders at the display refresh rate
+    QScreen* screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 0) {
+        minFrameInterval = qMax(1, (int)(1000 / screen->refreshRate()));
+    }
+
+    updateTimer.setSingleShot(true);
     connect(&updateTimer, SIGNAL(timeout()), this, SLOT(render()));
-    updateTimer.start(UPDATE_FREQ);
+    connect(preparer, SIGNAL(ready()), this, SLOT(applyPrepared()));
+    lastRender.start();
+}
+
+Engine::~Engine()
+{
+    // the overlay is a top level window, not a child
+    delete overlay;
+    // closes the trace with everything recorded so far
+    delete recorder;
+    delete types;
+    delete pool;
+}
+
+void Engine::record(QString path)
+{
+    delete recorder;
+    recorder = 0;
+    if (!path.isEmpty()) {
+        recorder = new Recorder(path);
+    }
+}
+
+void Engine::setFrameBudget(int budget, bool progressive)
+{
+    frameBudget = budget;
+    progressiveAttach = progressive;
+}
+
+void Engine::setFrameInterval(int minInterval, int maxInterval)
+{
+    minFrameInterval = qMax(0, minInterval);
+    maxFrameInterval = qMax(minFrameInterval, maxInterval);
+}
+
+void Engine::scheduleRender()
+{
+    // everything queued before the timer fires is coalesced into one pass
+    int delay = qMax(0, minFrameInterval - (int)lastRender.elapsed());
+    if (updateTimer.isActive() && updateTimer.remainingTime() <= delay) {
+        return;
+    }
+    updateTimer.start(delay);
+}
+
+void Engine::queueUpdate(QJsonObject json)
+{
+    // only the latest merged state per id is applied within a tick
+    QJsonValue value = json.value("id");
+    QString id = value.isDouble() ? QString::number(value.toInt()) : value.toString();
+    if (!updates.contains(id)) {
+        updateOrder.push_back(id);
+        updates.insert(id, json);
+        return;
+    }
+    QJsonObject& merged = updates[id];
+    for (auto it = json.begin(); it != json.end(); ++it) {
+        merged.insert(it.key(), it.value());
+    }
+    // the prepared fingerprint only covers the newer half
+    merged.remove("$styleHash");
+    droppedUpdates++;
+}
+
+void Engine::dispatchEvent(UIObject* obj, QString event, QVariant value)
+{
+    if (!obj->handle) {
+        return;
+    }
+    if (pendingEvents.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(flushEvents()));
+    }
+    pendingEvents << QVariant(QVariantList({ obj->handle, event, value }));
+}
+
+void Engine::noteBridgeCall()
+{
+    // first call from JS after an event batch closes the round trip
+    if (awaitingReply) {
+        roundTrips.add(eventClock.nsecsElapsed() / 1000);
+        awaitingReply = false;
+        replyTo = eventBatches;
+        replyCall = preparer->submittedCount() + 1;
+    }
+}
+
+void Engine::noteCommitted()
+{
+    // the reply is prepared off the gui thread, it is applied once
+    // delivered and rendered
+    if (replyCall && preparer->deliveredCount() >= replyCall) {
+        replyCall = 0;
+        emit committed(replyTo);
+    }
+}
+
+void Engine::flushEvents()
+{
+    if (pendingEvents.isEmpty()) {
+        return;
+    }
+    QVariantList batch = pendingEvents;
+    pendingEvents.clear();
+    if (recorder) {
+        recorder->record("event", QJsonDocument(QJsonArray::fromVariantList(batch)).toJson(QJsonDocument::Compact));
+    }
+    eventsSent += batch.size();
+    eventBatches++;
+    eventClock.restart();
+    awaitingReply = true;
+    emit events(batch);
+}
+
+void Engine::scheduleRelayout(UIObject* obj)
+{
+    relayouts.push_back(obj);
+}
+
+void Engine::flushRelayouts()
+{
+    PROFILE_SCOPE("relayout");
+    QList<QPointer<UIObject>> dirty = relayouts;
+    relayouts.clear();
+    for (auto obj : dirty) {
+        if (obj) {
+            obj->relayout();
+            relayoutCount++;
+        }
+    }
+}
+
+void Engine::scheduleIdle()
+{
+    if (updateTimer.isActive()) {
+        return;
+    }
+    updateTimer.start(maxFrameInterval);
 }
 
 void Engine::runFromUrl(QUrl path)
 {
+#ifndef JQN_HEADLESS
     view->setUrl(path);
+#endif
     basePath = path.adjusted(QUrl::RemoveFilename);
     qDebug() << basePath;
 }
 
-void Engine::addFactory(UIFactory* factory) { factories.push_back(factory); }
+void Engine::addFactory(UIFactory* factory)
+{
+    factory->setPool(pool);
+    factory->registerTypes(types);
+    factories.push_back(factory);
+}
 
 bool Engine::loadHtml(QString content, QUrl base)
 {
@@ -62,7 +242,9 @@ bool Engine::loadHtml(QString content, QUrl base)
 
     // content.replace("<script", "<!--script");
     // content.replace("/script>", "/script-->");
+#ifndef JQN_HEADLESS
     view->setHtml(content, base);
+#endif
     return true;
 }
 
@@ -78,14 +260,18 @@ bool Engine::loadHtmlFile(QString path, QUrl base)
 void Engine::startEngine()
 {
     qDebug() << "Engine::attachJSObjects";
-        
-    frame->addToJavaScriptWindowObject("$qt", this);
+
+    addToJavaScriptWindowObject("$qt", this);
 
     // this happens at reload
-    for (auto k : registry.keys()) {
-        UIObject* obj = registry.value(k);
-        unmounts << toJson("{\"id\": \"" + obj->property("id").toString() + "\"}");
+    for (int handle = 1; handle < registry.size(); handle++) {
+        if (registry[handle]) {
+            QJsonObject doc;
+            doc.insert("id", handle);
+            unmounts << doc;
+        }
     }
+    scheduleRender();
 
     emit engineReady();
 }
@@ -102,25 +288,60 @@ UIObject* Engine::create(QString id, QString type, bool persistent)
     // qDebug() << "----------------";
     // qDebug() << jsonString;
     mount(jsonString);
-    render();
+    flush();
     return findInRegistryById(id);
 }
 
+void Engine::flush()
+{
+    preparer->waitForDone();
+    render();
+}
+
+void Engine::setPrepareThreads(int count)
+{
+    preparer->setThreadCount(count);
+}
+
+int Engine::nodeCount()
+{
+    int count = 0;
+    for (auto obj : registry) {
+        if (obj) {
+            count++;
+        }
+    }
+    return count;
+}
+
 UIObject* Engine::findInRegistryById(QString id)
 {
-    return registry.value(id);
+    if (aliases.contains(id)) {
+        return findInRegistry(QJsonValue(aliases.value(id)));
+    }
+    return findInRegistry(QJsonValue(id.toInt()));
+}
+
+int Engine::handleOf(QJsonValue id)
+{
+    return id.isDouble() ? id.toInt() : aliases.value(id.toString());
 }
 
-UIObject* Engine::findInRegistry(QString id, QJsonObject json)
+UIObject* Engine::findInRegistry(QJsonValue id)
 {
-    if (!json.contains(id)) {
+    int handle = handleOf(id);
+    if (handle <= 0 || handle >= registry.size()) {
         return NULL;
     }
-    QString _id = json.value(id).toString();
-    if (!registry.contains(_id)) {
+    return registry[handle];
+}
+
+UIObject* Engine::findInRegistry(QString id, QJsonObject json)
+{
+    if (!json.contains(id)) {
         return NULL;
     }
-    return registry.value(_id);
+    return findInRegistry(json.value(id));
 }
 
 UIObject* Engine::addToRegistry(QJsonObject json, UIObject* object)
@@ -128,20 +349,106 @@ UIObject* Engine::addToRegistry(QJsonObject json, UIObject* object)
     if (!json.contains("id")) {
         return NULL;
     }
-    QString id = json.value("id").toString();
+    QJsonValue id = json.value("id");
+    QString alias = id.isString() ? id.toString() : json.value("alias").toString();
+    int handle = id.isDouble() ? id.toInt() : aliases.value(alias, 0);
+    if (!handle) {
+        handle = allocateHandle();
+    }
     object->setParent(this);
-    object->setProperty("id", id);
+    object->handle = handle;
+    object->setProperty("id", alias.isEmpty() ? QString::number(handle) : alias);
     object->setProperty("persistent", json.contains("persistent"));
-    registry.insert(id, object);
+    bindHandle(handle, object);
+    if (!alias.isEmpty()) {
+        aliases.insert(alias, handle);
+    }
     // qDebug() << "added to registry" << id;
     return object;
 }
 
+void Engine::removeFromRegistry(UIObject* object)
+{
+    int handle = object->handle;
+    if (handle <= 0 || handle >= registry.size() || registry[handle] != object) {
+        return;
+    }
+    registry[handle] = NULL;
+    freeHandles.push_back(handle);
+
+    QString alias = object->property("id").toString();
+    if (aliases.value(alias) == handle) {
+        aliases.remove(alias);
+    }
+}
+
+int Engine::allocateHandle()
+{
+    if (freeHandles.size()) {
+        int handle = freeHandles.last();
+        freeHandles.pop_back();
+        return handle;
+    }
+    return nextHandle++;
+}
+
+void Engine::bindHandle(int handle, UIObject* object)
+{
+    if (handle >= nextHandle) {
+        nextHandle = handle + 1;
+    }
+    if (handle >= registry.size()) {
+        registry.resize(qMax(handle + 1, registry.size() * 2));
+    }
+    registry[handle] = object;
+}
+
+void Engine::rebindHandle(UIObject* object, int handle)
+{
+    // a persistent node mounted again under a new handle. JS has dropped
+    // the old one, events go to the new one and the old slot is freed
+    int old = object->handle;
+    if (handle <= 0 || handle == old) {
+        return;
+    }
+    if (old > 0 && old < registry.size() && registry[old] == object) {
+        registry[old] = NULL;
+        freeHandles.push_back(old);
+    }
+    object->handle = handle;
+    bindHandle(handle, object);
+
+    QString alias = object->property("id").toString();
+    if (aliases.value(alias) == old) {
+        aliases.insert(alias, handle);
+    }
+}
+
+QVariantList Engine::reserveHandles(int count)
+{
+    QVariantList handles;
+    for (int i = 0; i < count; i++) {
+        handles << allocateHandle();
+    }
+    return handles;
+}
+
+void Engine::addToJavaScriptWindowObject(QString name, QObject* object)
+{
+#ifndef JQN_HEADLESS
+    frame->addToJavaScriptWindowObject(name, object);
+#endif
+}
+
 QVariant Engine::runScript(QString script)
 {
+#ifndef JQN_HEADLESS
     // qDebug() << script;
     // return frame->evaluateJavaScript("{" + script + "}");
     return frame->evaluateJavaScript(script);
+#else
+    return QVariant();
+#endif
 }
 
 QVariant Engine::runScriptFile(QString path)
@@ -153,76 +460,189 @@ QVariant Engine::runScriptFile(QString path)
     return QVariant();
 }
 
+// merges an update patch into a node kept as json, null removes a prop
+static void mergePatch(QJsonObject& doc, const QJsonObject& patch)
+{
+    for (auto p = patch.begin(); p != patch.end(); ++p) {
+        if (p.value().isNull()) {
+            doc.remove(p.key());
+        } else {
+            doc.insert(p.key(), p.value());
+        }
+    }
+    doc.remove("$styleHash");
+}
+
 //--------------------
 // private slots
 //--------------------
 void Engine::render()
 {
-    if (!mounts.size() && !updates.size() && !unmounts.size()) {
+    if (!mounts.size() && !updates.size() && !unmounts.size() && !moves.size()) {
         if (garbage.size()) {
-            for(auto obj : garbage) {
+            // children first, so parents are empty when recycled
+            for (int i = garbage.size() - 1; i >= 0; i--) {
+                UIObject* obj = garbage[i];
+                compiler->removeRules(obj);
+                if (obj->reset() && pool->release(obj)) {
+                    continue;
+                }
                 obj->unmount();
                 obj->deleteLater();
             }
             garbage.clear();
         }
+        flushRelayouts();
+        noteCommitted();
         return;
     }
-    
+
     updateTimer.stop();
+    lastRender.restart();
+
+    QElapsedTimer tick;
+    tick.start();
+
+    if (recorder) {
+        recorder->record("render");
+    }
+
+    PROFILE_SCOPE("render");
 
     QList<QJsonObject> retry;
 
-    for (auto doc : mounts) {
+    // with a frame budget the pass yields once it runs out and resumes on
+    // the next frame. mounts go first, in order, so parents always exist
+    // before their children; updates and unmounts wait for the mounts.
+    bool sliced = false;
+    auto overBudget = [&](int budget) {
+        return budget > 0 && tick.elapsed() >= budget;
+    };
+
+    int next = 0;
+    for (; next < mounts.size(); next++) {
+        if (next && overBudget(frameBudget)) {
+            sliced = true;
+            break;
+        }
+        QJsonObject doc = mounts[next];
+        bool create = doc.contains("$unplaced");
+        doc.remove("$unplaced");
         UIObject* obj = findInRegistry("id", doc);
         UIObject* parent = findInRegistry("parent", doc);
+        if (!obj && doc.contains("alias")) {
+            // persistent nodes may already exist under their alias
+            obj = findInRegistry("alias", doc);
+            if (obj) {
+                rebindHandle(obj, doc.value("id").toInt());
+            }
+        }
+        if (!obj && create) {
+            // host ops create a node once it is placed, so lazy parents
+            // decide before anything is built
+            Unplaced node;
+            node.doc = doc;
+            unplaced.insert(doc.value("id").toInt(), node);
+            continue;
+        }
         if (!obj) {
-            // create if not exists
-            for (auto f : factories) {
-                obj = f->create(doc);
-                if (obj) {
-                    obj->engine = this;
-                    obj->mount(doc);
-                    obj->update(doc);
-                    // if (parent) {
-                        // parent->addChild(obj);
-                    // }
-                    break;
-                }
+            if (trackMount(doc, parent)) {
+                continue;
             }
-            if (obj) {
-                if (parent) {
-                    parent->addChild(obj);
-                }
-                if (obj->widget()) {
-                    obj->widget()->setProperty("mounted", true);
-                }
-                if (addToRegistry(doc, obj)) {
-                    // qDebug() << "added to registry";
+            if (parent && frameBudget > 0 && !progressiveAttach && !building.contains(parent)) {
+                // new subtrees are attached once completely built
+                obj = createObject(doc, NULL);
+                if (obj) {
+                    building.insert(obj);
+                    pendingAttach << qMakePair(QPointer<UIObject>(obj), QPointer<UIObject>(parent));
                 }
             } else {
-                qDebug() << "unable to create";
-                qDebug() << doc;
+                obj = createObject(doc, parent);
+                if (obj && building.contains(parent)) {
+                    building.insert(obj);
+                }
             }
         } else {
+            retain(obj, doc);
             obj->update(doc);
-            if (doc.contains("retained") && obj->widget()) {
-                obj->widget()->show();
+            if (obj->widget() && (doc.contains("retained") || !obj->widget()->property("mounted").toBool())) {
+                // hidden by an earlier unmount or remove. a detached widget
+                // is shown by its parent once placed
+                if (obj->widget()->parentWidget()) {
+                    obj->widget()->show();
+                } else {
+                    obj->widget()->setAttribute(Qt::WA_WState_ExplicitShowHide, false);
+                }
                 obj->widget()->setProperty("mounted", true);
             }
             // qDebug() << "already exists";
         }
     }
-    mounts.clear();
-    mounts << retry;
-    retry.clear();
+    mounts = mounts.mid(next);
+
+    if (!sliced) {
+        for (auto attach : pendingAttach) {
+            if (attach.first && attach.second) {
+                attach.second->addChild(attach.first);
+            }
+        }
+        pendingAttach.clear();
+        building.clear();
+
+        // host ops place nodes once everything they refer to exists
+        next = 0;
+        for (; next < moves.size(); next++) {
+            if (next && overBudget(frameBudget)) {
+                sliced = true;
+                break;
+            }
+            place(moves[next]);
+        }
+        moves = moves.mid(next);
+    }
+    bool mountsDone = !sliced;
+
+    QList<QString> order = updateOrder;
+    QHash<QString, QJsonObject> pending = updates;
+    if (!sliced) {
+        updateOrder.clear();
+        updates.clear();
+        next = 0;
+    } else {
+        order.clear();
+    }
 
-    for (auto doc : updates) {
+    // a quarter of the frame is left to the unmounts, so a steady stream
+    // of updates can't hold them back
+    int updateBudget = unmounts.size() ? frameBudget * 3 / 4 : frameBudget;
+    for (; next < order.size(); next++) {
+        if (overBudget(updateBudget)) {
+            sliced = true;
+            break;
+        }
+        QJsonObject doc = pending.value(order[next]);
+        if (unplaced.size()) {
+            auto it = unplaced.find(doc.value("id").toInt());
+            if (it != unplaced.end()) {
+                mergePatch(it->doc, doc);
+                continue;
+            }
+        }
+        if (descriptors.size()) {
+            auto it = descriptors.find(doc.value("id").toInt());
+            if (it != descriptors.end()) {
+                mergePatch(it->doc, doc);
+                if (!it->materialized) {
+                    continue;
+                }
+            }
+        }
         UIObject* obj = findInRegistry("id", doc);
         if (obj) {
+            retain(obj, doc);
             obj->update(doc);
-            if (garbage.size() || !obj->widget()->parent()) {
-                UIObject* parent = findInRegistry("parent", doc);
+            if (!obj->widget()->parent()) {
+                UIObject* parent = findInRegistry("parent", obj->state);
                 if (parent) {
                     // qDebug() << "parented on update";
                     // qDebug() << doc.value("parent").toString();
@@ -233,37 +653,282 @@ void Engine::render()
             retry << doc;
         }
     }
-    updates.clear();
-    updates << retry;
+    for (; next < order.size(); next++) {
+        queueUpdate(pending.value(order[next]));
+    }
+    for (auto doc : retry) {
+        queueUpdate(doc);
+    }
 
-    for (auto doc : unmounts) {
-        UIObject* obj = findInRegistry("id", doc);
-        if (obj->property("persistent").toBool()) {
+    if (mountsDone) {
+        next = 0;
+        for (; next < unmounts.size(); next++) {
+            if (next && overBudget(frameBudget)) {
+                sliced = true;
+                break;
+            }
+            QJsonObject doc = unmounts[next];
+            if (descriptors.size() && unmountDescriptor(doc)) {
+                continue;
+            }
+            UIObject* obj = findInRegistry("id", doc);
+            if (!obj && unplaced.remove(doc.value("id").toInt())) {
+                // removed before it was ever placed
+                freeHandles.push_back(doc.value("id").toInt());
+                continue;
+            }
+            if (obj && obj->property("persistent").toBool()) {
 //             qDebug() << "persistent";
 //             qDebug() << doc;
-            if (doc.contains("retained") && obj->widget()) {
-                obj->widget()->hide();
-                obj->widget()->setProperty("mounted", false);
+                // a removed node is gone from the React tree, retained or not
+                if ((doc.contains("retained") || doc.contains("removed")) && obj->widget()) {
+                    obj->widget()->hide();
+                    obj->widget()->setProperty("mounted", false);
+                }
+                continue;
             }
-            continue;
-        }
-        if (obj) {
+            if (obj) {
 
-            garbage.push_back(obj);
-            obj->widget()->hide();
+                garbage.push_back(obj);
+                obj->widget()->hide();
+                obj->widget()->setProperty("mounted", false);
 
-            // obj->unmount(doc);
-            // obj->deleteLater();
+                // obj->unmount(doc);
+                // obj->deleteLater();
 
 //             qDebug() << "-----------------";
 //             qDebug() << "unmount";
 //             qDebug() << doc;
-            registry.remove(doc.value("id").toString());
+                removeFromRegistry(obj);
+
+                // updates still queued by a sliced pass came before the
+                // unmount, there is nothing left to apply them to
+                QJsonValue value = doc.value("id");
+                QString id = value.isDouble() ? QString::number(value.toInt()) : value.toString();
+                if (updates.remove(id)) {
+                    updateOrder.removeAll(id);
+                }
+            }
+        }
+        unmounts = unmounts.mid(next);
+    }
+
+    flushRelayouts();
+    compiler->commit();
+
+    if (recorder) {
+        recorder->flush();
+    }
+
+    renderTimes.add(tick.nsecsElapsed() / 1000);
+
+    if (sliced) {
+        scheduleRender();
+        return;
+    }
+    noteCommitted();
+
+    // unresolved updates are retried, unmounted objects collected later
+    if (mounts.size() || updates.size() || garbage.size()) {
+        scheduleIdle();
+    }
+}
+
+void Engine::retain(UIObject* obj, QJsonObject& patch)
+{
+    // merge an update patch into the retained props, null removes a prop.
+    // the prepared fingerprint only covers the patch
+    patch.remove("$styleHash");
+    if (patch.contains("style")) {
+        obj->state.remove("$styleText");
+    }
+    for (auto it = patch.begin(); it != patch.end(); ++it) {
+        if (it.value().isNull()) {
+            obj->state.remove(it.key());
+        } else {
+            obj->state.insert(it.key(), it.value());
+        }
+    }
+}
+
+UIObject* Engine::createObject(QJsonObject doc, UIObject* parent)
+{
+    UIObject* obj;
+    {
+        // registered types first
+        PROFILE_SCOPE("create");
+        obj = types->create(doc.value("type").toString());
+        for (int i = 0; !obj && i < factories.size(); i++) {
+            obj = factories[i]->create(doc);
+        }
+    }
+    if (!obj) {
+        qDebug() << "unable to create";
+        qDebug() << doc;
+        return NULL;
+    }
+    obj->engine = this;
+    addToRegistry(doc, obj);
+    obj->state = doc;
+    obj->state.remove("$styleHash");
+    obj->mount(doc);
+    obj->update(doc);
+    if (parent) {
+        parent->addChild(obj);
+    }
+    if (obj->widget()) {
+        obj->widget()->setProperty("mounted", true);
+    }
+    return obj;
+}
+
+bool Engine::trackMount(QJsonObject doc, UIObject* parent)
+{
+    // returns true when creation is deferred
+    if (!doc.value("id").isDouble()) {
+        return false;
+    }
+    int handle = doc.value("id").toInt();
+    int parentHandle = doc.value("parent").toInt();
+
+    UIObject::ChildMount mode = UIObject::MountNow;
+    auto it = descriptors.find(parentHandle);
+    if (it != descriptors.end()) {
+        // descendants of lazy nodes follow their parent
+        it->children << handle;
+        mode = it->materialized ? UIObject::MountTracked : UIObject::MountDeferred;
+    } else if (parent) {
+        mode = parent->childMount(doc);
+    }
+    if (mode == UIObject::MountNow) {
+        return false;
+    }
+
+    Descriptor d;
+    d.doc = doc;
+    d.materialized = (mode == UIObject::MountTracked);
+    descriptors.insert(handle, d);
+    if (mode == UIObject::MountDeferred) {
+        // keep the handle and alias reserved until materialized
+        bindHandle(handle, NULL);
+        if (doc.contains("alias")) {
+            aliases.insert(doc.value("alias").toString(), handle);
+        }
+        return true;
+    }
+    return false;
+}
+
+void Engine::place(QJsonObject move)
+{
+    int parentHandle = move.value("parent").toInt();
+    int handle = move.value("child").toInt();
+
+    auto pending = unplaced.find(parentHandle);
+    if (pending != unplaced.end()) {
+        // placed along with the parent, in order
+        pending->moves << move;
+        return;
+    }
+
+    // 0 places a top level node
+    UIObject* parent = findInRegistry(QJsonValue(parentHandle));
+    UIObject* before = findInRegistry("before", move);
+    auto it = unplaced.find(handle);
+    if (it == unplaced.end()) {
+        UIObject* child = findInRegistry(QJsonValue(handle));
+        if (child && parent) {
+            child->state.insert("parent", parentHandle);
+            parent->insertChild(child, before);
         }
+        return;
     }
-    unmounts.clear();
 
-    updateTimer.start(UPDATE_FREQ);
+    Unplaced node = unplaced.take(handle);
+    if (parentHandle) {
+        node.doc.insert("parent", parentHandle);
+    }
+    // children of deferred nodes become descriptors as well
+    if (!trackMount(node.doc, parent)) {
+        UIObject* obj = createObject(node.doc, NULL);
+        if (obj && parent) {
+            parent->insertChild(obj, before);
+        }
+    }
+    for (auto m : node.moves) {
+        place(m);
+    }
+}
+
+bool Engine::unmountDescriptor(QJsonObject doc)
+{
+    // returns true when the node was never materialized
+    int handle = doc.value("id").toInt();
+    auto it = descriptors.find(handle);
+    if (it == descriptors.end()) {
+        return false;
+    }
+    bool materialized = it->materialized;
+    auto parent = descriptors.find(it->doc.value("parent").toInt());
+    if (parent != descriptors.end()) {
+        parent->children.removeAll(handle);
+    }
+    descriptors.erase(it);
+    if (materialized) {
+        return false;
+    }
+    QString alias = doc.value("alias").toString();
+    if (aliases.value(alias) == handle) {
+        aliases.remove(alias);
+    }
+    freeHandles.push_back(handle);
+    return true;
+}
+
+UIObject* Engine::materialize(int handle)
+{
+    auto it = descriptors.find(handle);
+    if (it == descriptors.end() || it->materialized) {
+        return findInRegistry(QJsonValue(handle));
+    }
+    it->materialized = true;
+    QJsonObject doc = it->doc;
+    QList<int> children = it->children;
+
+    UIObject* obj = createObject(doc, findInRegistry("parent", doc));
+    for (auto child : children) {
+        materialize(child);
+    }
+    return obj;
+}
+
+void Engine::release(int handle)
+{
+    auto it = descriptors.find(handle);
+    if (it == descriptors.end() || !it->materialized) {
+        return;
+    }
+    it->materialized = false;
+    QList<int> children = it->children;
+
+    // parents go to the garbage first, it is swept children first
+    UIObject* obj = findInRegistry(QJsonValue(handle));
+    if (obj) {
+        registry[handle] = NULL;
+        obj->widget()->hide();
+        obj->widget()->setProperty("mounted", false);
+        garbage.push_back(obj);
+        scheduleIdle();
+    }
+    for (auto child : children) {
+        release(child);
+    }
+}
+
+bool Engine::isMaterialized(int handle)
+{
+    auto it = descriptors.find(handle);
+    return it == descriptors.end() ? findInRegistry(QJsonValue(handle)) != NULL : it->materialized;
 }
 
 //--------------------
@@ -271,6 +936,7 @@ void Engine::render()
 //--------------------
 void Engine::showInspector(bool withHtml)
 {
+#ifndef JQN_HEADLESS
     if (withHtml) {
         view->show();
     } else {
@@ -278,6 +944,7 @@ void Engine::showInspector(bool withHtml)
     }
 
     inspector->setPage(view->page());
+#endif
 
     resize(1200, 800);
     show();
@@ -288,14 +955,195 @@ void Engine::hideInspector()
     hide();
 }
 
-void Engine::mount(QString json) { mounts.push_back(toJson(json)); }
+void Engine::mount(QString json)
+{
+    noteBridgeCall();
+    if (recorder) {
+        recorder->record("mount", json);
+    }
+    preparer->submit("mount", json);
+}
+
+void Engine::update(QString json)
+{
+    noteBridgeCall();
+    if (recorder) {
+        recorder->record("update", json);
+    }
+    preparer->submit("update", json);
+}
+
+void Engine::unmount(QString json)
+{
+    noteBridgeCall();
+    if (recorder) {
+        recorder->record("unmount", json);
+    }
+    preparer->submit("unmount", json);
+}
+
+void Engine::commit(QString json)
+{
+    noteBridgeCall();
+    // a whole frame of operations in one call:
+    // [{ "op": "mount", "node": { ... } }, { "op": "update", "node": { ... } }, ...]
+    if (recorder) {
+        recorder->record("commit", json);
+    }
+    preparer->submit("commit", json);
+}
 
-void Engine::update(QString json) { updates.push_back(toJson(json)); }
+void Engine::createNode(QString json)
+{
+    noteBridgeCall();
+    if (recorder) {
+        recorder->record("create", json);
+    }
+    preparer->submit("create", json);
+}
 
-void Engine::unmount(QString json) { unmounts.push_back(toJson(json)); }
+static QString moveJson(int parent, int child, int before)
+{
+    QJsonObject move;
+    move.insert("parent", parent);
+    move.insert("child", child);
+    if (before) {
+        move.insert("before", before);
+    }
+    return QJsonDocument(move).toJson(QJsonDocument::Compact);
+}
+
+void Engine::appendChild(int parent, int child)
+{
+    insertBefore(parent, child, 0);
+}
+
+void Engine::insertBefore(int parent, int child, int before)
+{
+    noteBridgeCall();
+    QString json = moveJson(parent, child, before);
+    if (recorder) {
+        recorder->record("insert", json);
+    }
+    preparer->submit("insert", json);
+}
+
+void Engine::removeChild(int parent, int child)
+{
+    noteBridgeCall();
+    QString json = moveJson(parent, child, 0);
+    if (recorder) {
+        recorder->record("remove", json);
+    }
+    preparer->submit("remove", json);
+}
+
+void Engine::commitUpdate(QString json)
+{
+    update(json);
+}
+
+void Engine::applyPrepared()
+{
+    // parsed and style compiled off the gui thread, queued in order here
+    for (auto op : preparer->take()) {
+        if (op.op == "mount" || op.op == "create") {
+            // ops are queued by kind, so a remount of a persistent node
+            // would run before an unmount sent earlier in the batch. the
+            // remount supersedes it
+            if (unmounts.size() && op.node.contains("alias")) {
+                UIObject* obj = findInRegistry("alias", op.node);
+                for (int i = unmounts.size() - 1; obj && i >= 0; i--) {
+                    if (findInRegistry("id", unmounts[i]) == obj) {
+                        unmounts.removeAt(i);
+                    }
+                }
+            }
+            if (op.op == "create") {
+                op.node.insert("$unplaced", true);
+            }
+            mounts.push_back(op.node);
+            prefetchImage(op.node);
+        } else if (op.op == "update") {
+            queueUpdate(op.node);
+        } else if (op.op == "append" || op.op == "insert") {
+            moves.push_back(op.node);
+        } else if (op.op == "remove") {
+            QJsonObject doc;
+            doc.insert("id", op.node.value("child"));
+            doc.insert("removed", true);
+            unmounts.push_back(doc);
+        } else if (op.op == "unmount") {
+            unmounts.push_back(op.node);
+        } else if (op.op == "style") {
+            registerStyle(op.node.value("id").toInt(), op.node.value("style").toObject(), op.node.value("$styleText").toString());
+        }
+    }
+    scheduleRender();
+}
+
+void Engine::prefetchImage(QJsonObject node)
+{
+    // images with a fixed size start fetching and decoding before the
+    // widget exists, at the size it will request
+    if (node.value("type").toString() != "Image" || !node.contains("source")) {
+        return;
+    }
+    QJsonObject style = node.value("style").toObject();
+    if (!style.contains("width") || !style.contains("height")) {
+        return;
+    }
+    QPixmap pixmap;
+    QUrl url(basePath.toString() + node.value("source").toString());
+    images->load(url, QSize(style.value("width").toInt(), style.value("height").toInt()), 0, &pixmap);
+}
+
+QVariantMap Engine::stats()
+{
+    QVariantMap queues;
+    queues.insert("mounts", mounts.size());
+    queues.insert("updates", updates.size());
+    queues.insert("unmounts", unmounts.size());
+    queues.insert("relayouts", relayouts.size());
+    queues.insert("events", pendingEvents.size());
+
+    QVariantMap events;
+    events.insert("sent", eventsSent);
+    events.insert("roundTrip", roundTrips.toVariant());
+
+    QVariantMap res;
+    res.insert("queues", queues);
+    res.insert("registry", nodeCount());
+    res.insert("garbage", garbage.size());
+    res.insert("render", renderTimes.toVariant());
+    res.insert("styleSheets", compiler->sheetApplications());
+    res.insert("polishes", compiler->widgetPolishes());
+    res.insert("relayouts", relayoutCount);
+    res.insert("layoutPasses", FlexLayout::passes());
+    res.insert("droppedUpdates", droppedUpdates);
+    res.insert("events", events);
+    res.insert("pool", pool->stats());
+    return res;
+}
+
+void Engine::showStats(bool show)
+{
+    if (!show) {
+        delete overlay;
+        overlay = 0;
+        return;
+    }
+    if (!overlay) {
+        overlay = new StatsOverlay(this);
+    }
+    overlay->show();
+}
 
 void Engine::widget(QString id)
 {
+    if (recorder) {
+        recorder->record("widget", id);
+    }
     UIObject *uiObject = findInRegistryById(id);
     if (uiObject) {
         uiObject->addToJavaScriptWindowObject();
@@ -317,3 +1165,26 @@ QIcon Engine::registerIcon(QString id, QIcon icon)
     }
     return Engine::icon(id);
 }
+
+void Engine::registerStyle(int id, QJsonObject style, QString compiled)
+{
+    styles.insert(id, style);
+    if (compiled.isEmpty()) {
+        compiledStyles.remove(id);
+    } else {
+        compiledStyles.insert(id, compiled);
+    }
+}
+
+QJsonObject Engine::style(int id)
+{
+    return styles.value(id);
+}
+
+QString Engine::compiledStyle(int id)
+{
+    if (!compiledStyles.contains(id)) {
+        compiledStyles.insert(id, toStyle(styles.value(id)));
+    }
+    return compiledStyles.value(id);
+}
@@ -1,28 +1,51 @@
 #pragma once
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonObject>
+#include <QPair>
+#include <QPointer>
+#include <QSet>
 #include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+#include "stats.h"
+
+#ifndef JQN_HEADLESS
 #include <QWebFrame>
 #include <QWebInspector>
 #include <QWebPage>
 #include <QWebView>
-#include <QWidget>
+#endif
 
 class UIObject;
 class UIFactory;
+class StyleCompiler;
+class UIObjectPool;
+class UITypeRegistry;
+class ImageLoader;
+class Preparer;
+class Recorder;
 class QNetworkReply;
 
 class Engine : public QWidget {
     Q_OBJECT
 public:
     Engine(QWidget* parent = 0);
+    ~Engine();
 
     QUrl basePath;
 
+#ifndef JQN_HEADLESS
     QWebView* view;
     QWebFrame* frame;
     QWebInspector* inspector;
+#endif
 
+    // headless builds (JQN_HEADLESS) have no web view, scripts and
+    // javascript window objects are ignored
+    void addToJavaScriptWindowObject(QString name, QObject* object);
     QVariant runScript(QString script);
     QVariant runScriptFile(QString path);
 
@@ -32,13 +55,67 @@ public:
     void runFromUrl(QUrl path);
     void addFactory(UIFactory* factory);
 
+    // renders run only when operations are queued, at most once every
+    // minInterval ms (defaults to the display refresh rate). maxInterval
+    // bounds how long idle work (garbage collection, retries) is deferred.
+    void setFrameInterval(int minInterval, int maxInterval);
+
+    // a render pass yields to the event loop after budget ms (0 for no
+    // limit) and continues on the next frame. new subtrees are attached
+    // only once complete unless progressive is set.
+    void setFrameBudget(int budget, bool progressive = false);
+
+    // updates superseded by a newer update for the same id within a tick
+    int droppedUpdateCount() const { return droppedUpdates; }
+
+    // nodes are addressed by integer handles, string ids are kept as
+    // aliases for persistent nodes such as mainWindow
     UIObject* findInRegistryById(QString id);
     UIObject* findInRegistry(QString key, QJsonObject json);
+    UIObject* findInRegistry(QJsonValue id);
+    int handleOf(QJsonValue id);
     UIObject* addToRegistry(QJsonObject json, UIObject* object);
+    void removeFromRegistry(UIObject* object);
     UIObject* create(QString id, QString type, bool persistent);
 
+    // appends every bridge call, event batch and render tick to a trace
+    // file that Replayer can feed back, an empty path stops recording
+    void record(QString path);
+
+    // lazily mounted subtrees (see UIObject::childMount). materialize
+    // creates a deferred node and its deferred descendants and returns
+    // it, release turns a tracked subtree back into descriptors
+    UIObject* materialize(int handle);
+    void release(int handle);
+    bool isMaterialized(int handle);
+
+    // runs a render pass right away instead of waiting for the scheduler,
+    // after everything submitted has been prepared
+    void flush();
+
+    // bridge calls are parsed and their styles compiled on this many
+    // worker threads before the gui thread applies them, 0 for inline
+    void setPrepareThreads(int count);
+    int nodeCount();
+
     QIcon icon(QString id);
     QIcon registerIcon(QString id, QIcon icon);
+
+    // styles registered through StyleSheet.create, compiled to qss once
+    void registerStyle(int id, QJsonObject style, QString compiled = QString());
+    QJsonObject style(int id);
+    QString compiledStyle(int id);
+    StyleCompiler* styleCompiler() { return compiler; }
+    UIObjectPool* objectPool() { return pool; }
+    UITypeRegistry* typeRegistry() { return types; }
+    ImageLoader* imageLoader() { return images; }
+
+    // native events are queued and delivered to JS as structured data,
+    // once per event loop turn, through the events signal
+    void dispatchEvent(UIObject* obj, QString event, QVariant value);
+
+    // layout passes are deferred and run once per object per render tick
+    void scheduleRelayout(UIObject* obj);
     
 public slots:
     void showInspector(bool withHtml);
@@ -47,27 +124,128 @@ public slots:
     void mount(QString json);
     void update(QString json);
     void unmount(QString json);
+    void commit(QString json);
     void widget(QString id);
 
+    // host operations for a React reconciler. createNode only describes a
+    // node, it is created once placed with appendChild/insertBefore (parent
+    // 0 for top level nodes), so lazy parents can defer it. removeChild
+    // unmounts the child. the same ops can be batched through commit as
+    // create, append, insert ({ parent, child, before }) and remove.
+    void createNode(QString json);
+    void appendChild(int parent, int child);
+    void insertBefore(int parent, int child, int before);
+    void removeChild(int parent, int child);
+    void commitUpdate(QString json);
+    QVariantList reserveHandles(int count);
+
+    // rolling counters: queue depths, registry size, garbage backlog,
+    // render tick percentiles, stylesheet applications, relayouts, event
+    // round trips (events sent until the next call from JS) and object
+    // pool hits and misses per type
+    QVariantMap stats();
+    void showStats(bool show);
+
+    // the event batch that events dispatched now go out in
+    int nextEventBatch() const { return eventBatches + 1; }
+
 signals:
     void engineReady();
+    void events(QVariantList events);
+    // the calls JS made in reply to an event batch have been applied
+    void committed(int batch);
 
 private Q_SLOTS:
     void startEngine();
     void render();
+    void flushEvents();
+    void applyPrepared();
 
 private:
+    void scheduleRender();
+    void scheduleIdle();
+    void queueUpdate(QJsonObject json);
+    void flushRelayouts();
+    void noteBridgeCall();
+    void noteCommitted();
+    void prefetchImage(QJsonObject node);
+    UIObject* createObject(QJsonObject doc, UIObject* parent);
+    void retain(UIObject* obj, QJsonObject& patch);
+    bool trackMount(QJsonObject doc, UIObject* parent);
+    void place(QJsonObject move);
+    bool unmountDescriptor(QJsonObject doc);
+    int allocateHandle();
+    void bindHandle(int handle, UIObject* object);
+    void rebindHandle(UIObject* object, int handle);
+
     QTimer updateTimer;
-    QMap<QString, UIObject*> registry;
+    QElapsedTimer lastRender;
+    int minFrameInterval;
+    int maxFrameInterval;
+    int frameBudget;
+    bool progressiveAttach;
+    QSet<UIObject*> building;
+    QList<QPair<QPointer<UIObject>, QPointer<UIObject>>> pendingAttach;
+
+    QVector<UIObject*> registry;
+    QVector<int> freeHandles;
+    QHash<QString, int> aliases;
+    int nextHandle;
     QList<UIObject*> garbage;
+    UIObjectPool* pool;
+    UITypeRegistry* types;
+    QList<QPointer<UIObject>> relayouts;
+    QVariantList pendingEvents;
+
+    // lazy nodes by handle
+    struct Descriptor {
+        QJsonObject doc;
+        QList<int> children;
+        bool materialized;
+    };
+    QHash<int, Descriptor> descriptors;
+
+    // nodes from host ops, created once their append or insert arrives.
+    // moves into them wait with them, in order
+    struct Unplaced {
+        QJsonObject doc;
+        QList<QJsonObject> moves;
+    };
+    QHash<int, Unplaced> unplaced;
 
     // icons    
     QMap<QString, QIcon> icons;
+    ImageLoader* images;
+
+    // styles
+    QHash<int, QJsonObject> styles;
+    QHash<int, QString> compiledStyles;
+    StyleCompiler* compiler;
+
+    // requests are prepared off the gui thread first
+    Preparer* preparer;
     
     // requests
     QList<QJsonObject> mounts;
     QList<QJsonObject> unmounts;
-    QList<QJsonObject> updates;
+    QList<QJsonObject> moves;
+    QList<QString> updateOrder;
+    QHash<QString, QJsonObject> updates;
+    int droppedUpdates;
 
     QList<UIFactory*> factories;
+    Recorder* recorder;
+
+    // metrics
+    RollingSamples renderTimes;
+    RollingSamples roundTrips;
+    QElapsedTimer eventClock;
+    bool awaitingReply;
+    int eventsSent;
+    int eventBatches;
+    // the batch replied to and the bridge call carrying the reply
+    int replyTo;
+    int replyCall;
+    int relayoutCount;
+    StatsOverlay* overlay;
 };
\ No newline at end of file
@@ -0,0 +1,563 @@
+#include "flexlayout.h"
+
+#include <QWidget>
+#include <QLayoutItem>
+
+static int passCount = 0;
+
+bool FlexStyle::operator==(const FlexStyle& other) const
+{
+    return direction == other.direction
+        && wrap == other.wrap
+        && justifyContent == other.justifyContent
+        && alignItems == other.alignItems
+        && alignContent == other.alignContent
+        && rowGap == other.rowGap
+        && columnGap == other.columnGap
+        && flex == other.flex
+        && grow == other.grow
+        && shrink == other.shrink
+        && basis == other.basis
+        && width == other.width
+        && height == other.height
+        && alignSelf == other.alignSelf
+        && position == other.position
+        && left == other.left
+        && top == other.top
+        && right == other.right
+        && bottom == other.bottom;
+}
+
+// flex: n is shorthand for grow n, shrink 1 and a zero basis
+static qreal growOf(const FlexStyle& s)
+{
+    if (s.grow > 0) {
+        return s.grow;
+    }
+    return s.flex > 0 ? s.flex : 0;
+}
+
+static qreal shrinkOf(const FlexStyle& s)
+{
+    if (s.shrink > 0) {
+        return s.shrink;
+    }
+    return s.flex != 0 ? 1 : 0;
+}
+
+static FlexLength basisOf(const FlexStyle& s)
+{
+    if (s.basis.isAuto() && s.flex > 0) {
+        FlexLength zero;
+        zero.unit = FlexLength::Point;
+        return zero;
+    }
+    return s.basis;
+}
+
+static qreal clampSize(qreal v, qreal min, qreal max)
+{
+    return qMax(min, qMin(v, qMax(min, max)));
+}
+
+FlexLayout::FlexLayout(QWidget* parent)
+    : QLayout(parent)
+    , dirty(true)
+{
+    setContentsMargins(0, 0, 0, 0);
+    setSpacing(0);
+}
+
+FlexLayout::~FlexLayout()
+{
+    QLayoutItem* item;
+    while ((item = takeAt(0))) {
+        delete item;
+    }
+}
+
+int FlexLayout::passes()
+{
+    return passCount;
+}
+
+void FlexLayout::setStyle(const FlexStyle& style)
+{
+    if (style == container) {
+        return;
+    }
+    container = style;
+    invalidate();
+}
+
+void FlexLayout::setItemStyle(QWidget* w, const FlexStyle& style)
+{
+    for (int i = 0; i < items.size(); i++) {
+        if (items[i].item->widget() != w) {
+            continue;
+        }
+        if (items[i].style == style) {
+            return;
+        }
+        if (style.position == "absolute" && items[i].style.position != "absolute") {
+            // absolute items are drawn over the flow
+            w->raise();
+        }
+        items[i].style = style;
+        invalidate();
+        return;
+    }
+}
+
+void FlexLayout::insertWidget(int index, QWidget* w)
+{
+    addChildWidget(w);
+    Item it;
+    it.item = new QWidgetItem(w);
+    if (index < 0 || index > items.size()) {
+        index = items.size();
+    }
+    items.insert(index, it);
+    invalidate();
+}
+
+void FlexLayout::reorder(const QVector<int>& target)
+{
+    bool moved = false;
+    for (int i = 0; i < target.size(); i++) {
+        moved |= target[i] != i;
+    }
+    if (!moved || target.size() != items.size()) {
+        return;
+    }
+    QList<Item> ordered;
+    for (int i : target) {
+        ordered << items[i];
+    }
+    items = ordered;
+    invalidate();
+}
+
+void FlexLayout::addItem(QLayoutItem* item)
+{
+    Item it;
+    it.item = item;
+    items << it;
+    invalidate();
+}
+
+int FlexLayout::count() const
+{
+    return items.size();
+}
+
+QLayoutItem* FlexLayout::itemAt(int index) const
+{
+    if (index < 0 || index >= items.size()) {
+        return 0;
+    }
+    return items[index].item;
+}
+
+QLayoutItem* FlexLayout::takeAt(int index)
+{
+    if (index < 0 || index >= items.size()) {
+        return 0;
+    }
+    QLayoutItem* item = items.takeAt(index).item;
+    invalidate();
+    return item;
+}
+
+Qt::Orientations FlexLayout::expandingDirections() const
+{
+    return Qt::Orientations();
+}
+
+void FlexLayout::invalidate()
+{
+    dirty = true;
+    cachedHint = QSize();
+    cachedMinimum = QSize();
+    QLayout::invalidate();
+}
+
+bool FlexLayout::isRow() const
+{
+    return container.direction.startsWith("row");
+}
+
+QSize FlexLayout::sizeHint() const
+{
+    if (!cachedHint.isValid()) {
+        cachedHint = measure(false);
+    }
+    return cachedHint;
+}
+
+QSize FlexLayout::minimumSize() const
+{
+    if (!cachedMinimum.isValid()) {
+        cachedMinimum = measure(true);
+    }
+    return cachedMinimum;
+}
+
+QSize FlexLayout::measure(bool minimum) const
+{
+    bool row = isRow();
+    bool wrap = !container.wrap.isEmpty() && container.wrap != "nowrap";
+    int gap = row ? container.columnGap : container.rowGap;
+
+    int main = 0;
+    int cross = 0;
+    int n = 0;
+    for (auto it : items) {
+        if (it.item->isEmpty() || it.style.position == "absolute") {
+            continue;
+        }
+        QSize size = minimum ? it.item->minimumSize() : it.item->sizeHint();
+        if (!minimum) {
+            // fixed sizes replace the measured ones, percentages need a container
+            if (it.style.width.unit == FlexLength::Point) {
+                size.setWidth(it.style.width.value);
+            }
+            if (it.style.height.unit == FlexLength::Point) {
+                size.setHeight(it.style.height.value);
+            }
+        }
+        int m = row ? size.width() : size.height();
+        int c = row ? size.height() : size.width();
+        if (minimum && wrap) {
+            main = qMax(main, m);
+        } else {
+            main += m + (n ? gap : 0);
+        }
+        cross = qMax(cross, c);
+        n++;
+    }
+
+    QMargins margins = contentsMargins();
+    QSize res = row ? QSize(main, cross) : QSize(cross, main);
+    return res + QSize(margins.left() + margins.right(), margins.top() + margins.bottom());
+}
+
+void FlexLayout::setGeometry(const QRect& rect)
+{
+    QLayout::setGeometry(rect);
+    if (!dirty && rect == lastRect) {
+        // nothing below changed, the children keep their geometry
+        return;
+    }
+    lastRect = rect;
+    dirty = false;
+    passCount++;
+    layoutItems(rect);
+}
+
+void FlexLayout::layoutItems(const QRect& rect)
+{
+    QRect inner = rect.marginsRemoved(contentsMargins());
+
+    bool row = isRow();
+    bool reverse = container.direction.endsWith("-reverse");
+    bool wrap = !container.wrap.isEmpty() && container.wrap != "nowrap";
+    bool wrapReverse = container.wrap == "wrap-reverse";
+    qreal mainAvail = row ? inner.width() : inner.height();
+    qreal crossAvail = row ? inner.height() : inner.width();
+    qreal mainGap = row ? container.columnGap : container.rowGap;
+    qreal crossGap = row ? container.rowGap : container.columnGap;
+    QString alignItems = container.alignItems.isEmpty() ? QString("stretch") : container.alignItems;
+
+    auto mainOf = [row](const QSize& s) { return (qreal)(row ? s.width() : s.height()); };
+    auto crossOf = [row](const QSize& s) { return (qreal)(row ? s.height() : s.width()); };
+
+    // flow items and their measurements, in order
+    struct Flow {
+        QLayoutItem* item;
+        QString align;
+        FlexLength mainSize;
+        FlexLength crossSize;
+        qreal grow;
+        qreal shrink;
+        qreal base;
+        qreal hyp;
+        qreal min;
+        qreal max;
+        qreal size;
+        qreal cross;
+        bool frozen;
+    };
+    QVector<Flow> flow;
+    QList<const Item*> absolute;
+
+    for (int i = 0; i < items.size(); i++) {
+        const Item& it = items[i];
+        if (it.item->isEmpty()) {
+            continue;
+        }
+        if (it.style.position == "absolute") {
+            absolute << &it;
+            continue;
+        }
+        Flow f;
+        f.item = it.item;
+        f.align = (it.style.alignSelf.isEmpty() || it.style.alignSelf == "auto") ? alignItems : it.style.alignSelf;
+        f.mainSize = row ? it.style.width : it.style.height;
+        f.crossSize = row ? it.style.height : it.style.width;
+        f.grow = growOf(it.style);
+        f.shrink = shrinkOf(it.style);
+        f.min = mainOf(it.item->minimumSize());
+        f.max = mainOf(it.item->maximumSize());
+
+        qreal hint;
+        if (!row && it.item->hasHeightForWidth()) {
+            // wrapped text, its height depends on the width it gets
+            qreal width = f.crossSize.resolve(crossAvail, f.align == "stretch" ? crossAvail : it.item->sizeHint().width());
+            hint = it.item->heightForWidth(qRound(width));
+        } else {
+            hint = mainOf(it.item->sizeHint());
+        }
+        FlexLength basis = basisOf(it.style);
+        f.base = basis.isAuto() ? f.mainSize.resolve(mainAvail, hint) : basis.resolve(mainAvail, hint);
+        f.hyp = clampSize(f.base, f.min, f.max);
+        f.size = f.hyp;
+        f.cross = 0;
+        f.frozen = false;
+        flow << f;
+    }
+
+    // break into lines
+    struct Line {
+        int first;
+        int last;
+        qreal cross;
+    };
+    QVector<Line> lines;
+    {
+        Line line = { 0, 0, 0 };
+        qreal used = 0;
+        for (int i = 0; i < flow.size(); i++) {
+            qreal next = used + (i > line.first ? mainGap : 0) + flow[i].hyp;
+            if (wrap && i > line.first && next > mainAvail) {
+                line.last = i;
+                lines << line;
+                line.first = i;
+                next = flow[i].hyp;
+            }
+            used = next;
+        }
+        line.last = flow.size();
+        if (line.last > line.first) {
+            lines << line;
+        }
+    }
+
+    // resolve the flexible lengths of each line
+    for (auto& line : lines) {
+        int n = line.last - line.first;
+        qreal gaps = mainGap * (n - 1);
+        qreal used = gaps;
+        for (int i = line.first; i < line.last; i++) {
+            used += flow[i].hyp;
+        }
+        bool growing = used < mainAvail;
+        for (int i = line.first; i < line.last; i++) {
+            Flow& f = flow[i];
+            f.frozen = (growing ? f.grow == 0 : f.shrink == 0)
+                || (growing && f.base > f.hyp)
+                || (!growing && f.base < f.hyp);
+            f.size = f.hyp;
+        }
+
+        for (int pass = 0; pass <= n; pass++) {
+            qreal space = mainAvail - gaps;
+            qreal factors = 0;
+            for (int i = line.first; i < line.last; i++) {
+                const Flow& f = flow[i];
+                space -= f.frozen ? f.size : f.base;
+                if (!f.frozen) {
+                    factors += growing ? f.grow : f.shrink * f.base;
+                }
+            }
+            if (factors <= 0) {
+                break;
+            }
+            if (growing && factors < 1) {
+                // grow factors below 1 take only their share of the space
+                space *= factors;
+            }
+
+            qreal violation = 0;
+            for (int i = line.first; i < line.last; i++) {
+                Flow& f = flow[i];
+                if (f.frozen) {
+                    continue;
+                }
+                qreal ratio = growing ? f.grow / factors : f.shrink * f.base / factors;
+                qreal size = f.base + space * ratio;
+                f.size = clampSize(size, f.min, f.max);
+                violation += f.size - size;
+            }
+
+            // freeze the items clamped in the direction of the violation
+            bool done = true;
+            for (int i = line.first; i < line.last; i++) {
+                Flow& f = flow[i];
+                if (f.frozen) {
+                    continue;
+                }
+                qreal size = f.size;
+                bool clampedMin = size <= f.min && violation > 0;
+                bool clampedMax = size >= f.max && violation < 0;
+                if (violation == 0 || clampedMin || clampedMax) {
+                    f.frozen = true;
+                } else {
+                    done = false;
+                }
+            }
+            if (done) {
+                break;
+            }
+        }
+
+        // cross sizes, the line is as tall as its tallest item
+        line.cross = 0;
+        for (int i = line.first; i < line.last; i++) {
+            Flow& f = flow[i];
+            qreal hint;
+            if (row && f.item->hasHeightForWidth()) {
+                hint = f.item->heightForWidth(qRound(f.size));
+            } else {
+                hint = crossOf(f.item->sizeHint());
+            }
+            f.cross = clampSize(f.crossSize.resolve(crossAvail, hint), crossOf(f.item->minimumSize()), crossOf(f.item->maximumSize()));
+            line.cross = qMax(line.cross, f.cross);
+        }
+    }
+
+    // a single line fills the container
+    if (!wrap && lines.size() == 1) {
+        lines[0].cross = crossAvail;
+    }
+
+    // distribute the lines over the cross axis
+    qreal crossStart = 0;
+    qreal crossBetween = 0;
+    if (wrap && lines.size()) {
+        qreal used = crossGap * (lines.size() - 1);
+        for (auto line : lines) {
+            used += line.cross;
+        }
+        qreal space = crossAvail - used;
+        QString align = container.alignContent;
+        if (align == "stretch" && space > 0) {
+            for (auto& line : lines) {
+                line.cross += space / lines.size();
+            }
+        } else if (align == "flex-end") {
+            crossStart = space;
+        } else if (align == "center") {
+            crossStart = space / 2;
+        } else if (align == "space-between" && lines.size() > 1 && space > 0) {
+            crossBetween = space / (lines.size() - 1);
+        } else if (align == "space-around" && space > 0) {
+            crossBetween = space / lines.size();
+            crossStart = crossBetween / 2;
+        }
+    }
+
+    auto place = [&](QLayoutItem* item, qreal main, qreal mainSize, qreal cross, qreal crossSize) {
+        int m0 = qRound(main);
+        int m1 = qRound(main + mainSize);
+        int c0 = qRound(cross);
+        int c1 = qRound(cross + crossSize);
+        QRect r = row ? QRect(inner.x() + m0, inner.y() + c0, m1 - m0, c1 - c0)
+                      : QRect(inner.x() + c0, inner.y() + m0, c1 - c0, m1 - m0);
+        item->setGeometry(r);
+    };
+
+    qreal lineOffset = crossStart;
+    for (auto line : lines) {
+        int n = line.last - line.first;
+        qreal remaining = mainAvail - mainGap * (n - 1);
+        for (int i = line.first; i < line.last; i++) {
+            remaining -= flow[i].size;
+        }
+
+        qreal start = 0;
+        qreal between = 0;
+        QString justify = container.justifyContent;
+        if (justify == "flex-end") {
+            start = remaining;
+        } else if (justify == "center") {
+            start = remaining / 2;
+        } else if (remaining > 0) {
+            if (justify == "space-between" && n > 1) {
+                between = remaining / (n - 1);
+            } else if (justify == "space-around") {
+                between = remaining / n;
+                start = between / 2;
+            } else if (justify == "space-evenly") {
+                between = remaining / (n + 1);
+                start = between;
+            }
+        }
+
+        qreal pos = start;
+        for (int i = line.first; i < line.last; i++) {
+            const Flow& f = flow[i];
+
+            qreal crossSize = f.cross;
+            qreal crossPos = 0;
+            if (f.align == "stretch" && f.crossSize.isAuto()) {
+                crossSize = clampSize(line.cross, crossOf(f.item->minimumSize()), crossOf(f.item->maximumSize()));
+            } else if (f.align == "flex-end") {
+                crossPos = line.cross - crossSize;
+            } else if (f.align == "center") {
+                crossPos = (line.cross - crossSize) / 2;
+            }
+            crossPos += lineOffset;
+            if (wrapReverse) {
+                crossPos = crossAvail - crossPos - crossSize;
+            }
+
+            qreal mainPos = reverse ? mainAvail - pos - f.size : pos;
+            place(f.item, mainPos, f.size, crossPos, crossSize);
+            pos += f.size + mainGap + between;
+        }
+        lineOffset += line.cross + crossGap + crossBetween;
+    }
+
+    // absolute items are placed by their offsets, outside the flow
+    for (auto it : absolute) {
+        const FlexStyle& s = it->style;
+        QSize hint = it->item->sizeHint();
+        QSize min = it->item->minimumSize();
+        QSize max = it->item->maximumSize();
+        qreal w = s.width.resolve(inner.width(), hint.width());
+        qreal h = s.height.resolve(inner.height(), hint.height());
+        if (s.width.isAuto() && !s.left.isAuto() && !s.right.isAuto()) {
+            w = inner.width() - s.left.resolve(inner.width(), 0) - s.right.resolve(inner.width(), 0);
+        }
+        if (s.height.isAuto() && !s.top.isAuto() && !s.bottom.isAuto()) {
+            h = inner.height() - s.top.resolve(inner.height(), 0) - s.bottom.resolve(inner.height(), 0);
+        }
+        w = clampSize(w, min.width(), max.width());
+        h = clampSize(h, min.height(), max.height());
+
+        qreal x = 0;
+        qreal y = 0;
+        if (!s.left.isAuto()) {
+            x = s.left.resolve(inner.width(), 0);
+        } else if (!s.right.isAuto()) {
+            x = inner.width() - s.right.resolve(inner.width(), 0) - w;
+        }
+        if (!s.top.isAuto()) {
+            y = s.top.resolve(inner.height(), 0);
+        } else if (!s.bottom.isAuto()) {
+            y = inner.height() - s.bottom.resolve(inner.height(), 0) - h;
+        }
+        it->item->setGeometry(QRect(inner.x() + qRound(x), inner.y() + qRound(y), qRound(w), qRound(h)));
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <QLayout>
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+// A length from the style, in pixels or a percentage of the container.
+struct FlexLength {
+    enum Unit {
+        Auto,
+        Point,
+        Percent
+    };
+
+    FlexLength()
+        : unit(Auto)
+        , value(0)
+    {
+    }
+
+    bool isAuto() const { return unit == Auto; }
+
+    // pixels, a percentage resolves against base
+    qreal resolve(qreal base, qreal fallback) const
+    {
+        if (unit == Point) {
+            return value;
+        }
+        if (unit == Percent) {
+            return base * value / 100;
+        }
+        return fallback;
+    }
+
+    bool operator==(const FlexLength& other) const { return unit == other.unit && value == other.value; }
+    bool operator!=(const FlexLength& other) const { return !(*this == other); }
+
+    Unit unit;
+    qreal value;
+};
+
+// Flexbox props of a node, with React Native defaults: column direction,
+// stretched children, no wrapping and no shrinking. The container props
+// apply to the node's own children, the item props to its place in the
+// parent.
+struct FlexStyle {
+    FlexStyle()
+        : rowGap(0)
+        , columnGap(0)
+        , flex(0)
+        , grow(0)
+        , shrink(0)
+    {
+    }
+
+    // container
+    QString direction;
+    QString wrap;
+    QString justifyContent;
+    QString alignItems;
+    QString alignContent;
+    int rowGap;
+    int columnGap;
+
+    // item
+    qreal flex;
+    qreal grow;
+    qreal shrink;
+    FlexLength basis;
+    FlexLength width;
+    FlexLength height;
+    QString alignSelf;
+    QString position;
+    FlexLength left;
+    FlexLength top;
+    FlexLength right;
+    FlexLength bottom;
+
+    bool operator==(const FlexStyle& other) const;
+    bool operator!=(const FlexStyle& other) const { return !(*this == other); }
+};
+
+// Lays out its items by the flexbox rules: grow, shrink and basis, wrap
+// with align-content, gaps and absolutely positioned items. Geometries are
+// set directly on the items. Measurements are cached until the layout or
+// one of its items is invalidated, and an unchanged layout keeps its
+// computed geometries, so only dirty subtrees are laid out again.
+class FlexLayout : public QLayout {
+    Q_OBJECT
+public:
+    FlexLayout(QWidget* parent = 0);
+    ~FlexLayout();
+
+    void setStyle(const FlexStyle& style);
+    const FlexStyle& style() const { return container; }
+
+    // per item props, items default to FlexStyle()
+    void setItemStyle(QWidget* w, const FlexStyle& style);
+
+    void insertWidget(int index, QWidget* w);
+
+    // puts the items in the given order, target[i] is the current index
+    // of the item to place at i
+    void reorder(const QVector<int>& target);
+
+    void addItem(QLayoutItem* item) override;
+    int count() const override;
+    QLayoutItem* itemAt(int index) const override;
+    QLayoutItem* takeAt(int index) override;
+
+    QSize sizeHint() const override;
+    QSize minimumSize() const override;
+    Qt::Orientations expandingDirections() const override;
+
+    void setGeometry(const QRect& rect) override;
+    void invalidate() override;
+
+    // layout passes that were actually computed, for the profiler
+    static int passes();
+
+private:
+    struct Item {
+        QLayoutItem* item;
+        FlexStyle style;
+    };
+
+    bool isRow() const;
+    QSize measure(bool minimum) const;
+    void layoutItems(const QRect& rect);
+
+    QList<Item> items;
+    FlexStyle container;
+
+    mutable QSize cachedHint;
+    mutable QSize cachedMinimum;
+    QRect lastRect;
+    bool dirty;
+};
@@ -0,0 +1,183 @@
+#include "images.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QImageReader>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRunnable>
+#include <QThreadPool>
+
+#define IMAGE_CACHE_SIZE (64 * 1024 * 1024)
+#define SOURCE_CACHE_SIZE (32 * 1024 * 1024)
+#define SIZE_BUCKET 16
+
+class ImageDecoder : public QRunnable {
+public:
+    ImageDecoder(ImageLoader* loader, QString key, QByteArray data, QSize size)
+        : loader(loader)
+        , key(key)
+        , data(data)
+        , size(size)
+    {
+    }
+
+    void run() override
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        reader.setAutoDetectImageFormat(true);
+
+        // decode straight at the displayed size, keeping the aspect ratio
+        QSize source = reader.size();
+        if (source.isValid() && size.isValid() && !size.isEmpty()) {
+            reader.setScaledSize(source.scaled(size, Qt::KeepAspectRatio));
+        }
+
+        QImage image = reader.read();
+        if (image.isNull()) {
+            qDebug() << reader.errorString();
+        }
+        QMetaObject::invokeMethod(loader, "imageDecoded", Qt::QueuedConnection,
+            Q_ARG(QString, key), Q_ARG(QImage, image));
+    }
+
+private:
+    ImageLoader* loader;
+    QString key;
+    QByteArray data;
+    QSize size;
+};
+
+ImageLoader::ImageLoader(QObject* parent)
+    : QObject(parent)
+    , netman(new QNetworkAccessManager(this))
+    , pixmaps(IMAGE_CACHE_SIZE)
+    , sources(SOURCE_CACHE_SIZE)
+{
+    connect(netman, SIGNAL(finished(QNetworkReply*)), this, SLOT(replyFinished(QNetworkReply*)));
+}
+
+QSize ImageLoader::bucket(QSize size)
+{
+    // round down, the decoded image always fits the widget
+    if (!size.isValid() || size.isEmpty()) {
+        return QSize();
+    }
+    int w = qMax(SIZE_BUCKET, size.width() - size.width() % SIZE_BUCKET);
+    int h = qMax(SIZE_BUCKET, size.height() - size.height() % SIZE_BUCKET);
+    return QSize(w, h);
+}
+
+QString ImageLoader::key(QUrl url, QSize size)
+{
+    size = bucket(size);
+    return url.toString() + "@" + QString::number(size.width()) + "x" + QString::number(size.height());
+}
+
+bool ImageLoader::load(QUrl url, QSize size, QObject* receiver, QPixmap* pixmap)
+{
+    size = bucket(size);
+    QString k = key(url, size);
+    QPixmap* cached = pixmaps.object(k);
+    if (cached) {
+        *pixmap = *cached;
+        return true;
+    }
+
+    if (decoding.contains(k)) {
+        decoding[k] << receiver;
+        return false;
+    }
+
+    QByteArray* source = sources.object(url);
+    if (source) {
+        decode(url, *source, size);
+        decoding[k] << receiver;
+        return false;
+    }
+
+    Request request;
+    request.size = size;
+    request.receiver = receiver;
+    if (!fetching.contains(url)) {
+        netman->get(QNetworkRequest(url));
+    }
+    fetching[url] << request;
+    return false;
+}
+
+void ImageLoader::setCacheSize(int bytes)
+{
+    pixmaps.setMaxCost(bytes);
+}
+
+void ImageLoader::setSourceCacheSize(int bytes)
+{
+    sources.setMaxCost(bytes);
+}
+
+void ImageLoader::setDiskCache(QString path, qint64 bytes)
+{
+    QNetworkDiskCache* cache = new QNetworkDiskCache(netman);
+    cache->setCacheDirectory(path);
+    cache->setMaximumCacheSize(bytes);
+    netman->setCache(cache);
+}
+
+void ImageLoader::replyFinished(QNetworkReply* reply)
+{
+    reply->deleteLater();
+    QUrl url = reply->request().url();
+    QList<Request> requests = fetching.take(url);
+    if (reply->error()) {
+        qDebug() << reply->errorString();
+        for (auto request : requests) {
+            notify(key(url, request.size), QList<QPointer<QObject>>() << request.receiver, QPixmap());
+        }
+        return;
+    }
+
+    QByteArray data = reply->readAll();
+    sources.insert(url, new QByteArray(data), data.size());
+    for (auto request : requests) {
+        QString k = key(url, request.size);
+        if (!decoding.contains(k)) {
+            decode(url, data, request.size);
+        }
+        decoding[k] << request.receiver;
+    }
+}
+
+void ImageLoader::decode(QUrl url, QByteArray data, QSize size)
+{
+    QThreadPool::globalInstance()->start(new ImageDecoder(this, key(url, size), data, size));
+}
+
+void ImageLoader::imageDecoded(QString key, QImage image)
+{
+    QList<QPointer<QObject>> receivers = decoding.take(key);
+    if (image.isNull()) {
+        notify(key, receivers, QPixmap());
+        return;
+    }
+
+    // pixmaps can only be created on the gui thread
+    QPixmap pixmap = QPixmap::fromImage(image);
+    int cost = pixmap.width() * pixmap.height() * qMax(1, pixmap.depth() / 8);
+    pixmaps.insert(key, new QPixmap(pixmap), cost);
+    notify(key, receivers, pixmap);
+}
+
+void ImageLoader::notify(QString key, QList<QPointer<QObject>> receivers, QPixmap pixmap)
+{
+    for (auto receiver : receivers) {
+        if (receiver) {
+            QMetaObject::invokeMethod(receiver, "setImage",
+                Q_ARG(QString, key), Q_ARG(QPixmap, pixmap));
+        }
+    }
+}
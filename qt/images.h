@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QSize>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Engine wide image service. Sources are fetched once through a shared
+// network manager, decoded on the thread pool directly at the requested
+// size and kept in a byte bounded LRU of pixmaps. Encoded sources are
+// kept in a second LRU so other sizes decode without refetching.
+class ImageLoader : public QObject {
+    Q_OBJECT
+public:
+    ImageLoader(QObject* parent = 0);
+
+    // sizes are quantized so small layout changes reuse a variant
+    static QSize bucket(QSize size);
+    static QString key(QUrl url, QSize size);
+
+    // returns true with the pixmap when cached, otherwise the receiver's
+    // setImage(QString key, QPixmap pixmap) slot is invoked once decoded,
+    // with a null pixmap when fetching or decoding failed
+    bool load(QUrl url, QSize size, QObject* receiver, QPixmap* pixmap);
+
+    void setCacheSize(int bytes);
+    void setSourceCacheSize(int bytes);
+    void setDiskCache(QString path, qint64 bytes);
+
+private Q_SLOTS:
+    void replyFinished(QNetworkReply* reply);
+    void imageDecoded(QString key, QImage image);
+
+private:
+    struct Request {
+        QSize size;
+        QPointer<QObject> receiver;
+    };
+
+    void decode(QUrl url, QByteArray data, QSize size);
+    void notify(QString key, QList<QPointer<QObject>> receivers, QPixmap pixmap);
+
+    QNetworkAccessManager* netman;
+    QCache<QString, QPixmap> pixmaps;
+
+    // encoded sources, re-rasterized when a new size is requested
+    QCache<QUrl, QByteArray> sources;
+
+    // in-flight fetches per source and decodes per key
+    QHash<QUrl, QList<Request>> fetching;
+    QHash<QString, QList<QPointer<QObject>>> decoding;
+};
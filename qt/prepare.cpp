@@ -0,0 +1,163 @@
+#include "prepare.h"
+#include "core.h"
+#include "profiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QRunnable>
+
+class PrepareTask : public QRunnable {
+public:
+    PrepareTask(Preparer* preparer, int sequence, QString op, QString json)
+        : preparer(preparer)
+        , sequence(sequence)
+        , op(op)
+        , json(json)
+    {
+    }
+
+    void run() override
+    {
+        preparer->finished(sequence, Preparer::prepare(op, json));
+    }
+
+private:
+    Preparer* preparer;
+    int sequence;
+    QString op;
+    QString json;
+};
+
+static QJsonObject prepareNode(QString op, QJsonObject node)
+{
+    // update patches list removed props, they are applied as null
+    if (node.contains("$removed")) {
+        for (auto k : node.value("$removed").toArray()) {
+            node.insert(k.toString(), QJsonValue(QJsonValue::Null));
+        }
+        node.remove("$removed");
+    }
+    if (node.contains("style")) {
+        node.insert("$styleText", toStyle(node.value("style").toObject()));
+    }
+    // only a created node's fingerprint is used, a patch's is dropped when
+    // merged into the retained props
+    if (op == "mount" || op == "create") {
+        node.insert("$styleHash", (double)styleFingerprint(node));
+    }
+    return node;
+}
+
+Preparer::Preparer(QObject* parent)
+    : QObject(parent)
+    , inlined(false)
+    , submitted(0)
+    , delivered(0)
+{
+}
+
+Preparer::~Preparer()
+{
+    // workers report back into members
+    pool.waitForDone();
+}
+
+void Preparer::setThreadCount(int count)
+{
+    waitForDone();
+    inlined = (count <= 0);
+    if (!inlined) {
+        pool.setMaxThreadCount(count);
+    }
+}
+
+void Preparer::submit(QString op, QString json)
+{
+    int sequence = submitted++;
+    if (inlined) {
+        finished(sequence, prepare(op, json));
+        return;
+    }
+    pool.start(new PrepareTask(this, sequence, op, json));
+}
+
+void Preparer::waitForDone()
+{
+    pool.waitForDone();
+    deliver();
+}
+
+QList<PreparedOp> Preparer::take()
+{
+    QList<PreparedOp> res = out;
+    out.clear();
+    return res;
+}
+
+QList<PreparedOp> Preparer::prepare(QString op, QString json)
+{
+    PROFILE_SCOPE("toJson");
+
+    QList<PreparedOp> res;
+    QByteArray bytes = json.toUtf8();
+    if (op != "commit") {
+        PreparedOp p;
+        p.op = op;
+        p.node = QJsonDocument::fromJson(bytes).object();
+        if (op != "insert" && op != "remove") {
+            p.node = prepareNode(op, p.node);
+        }
+        res << p;
+        return res;
+    }
+
+    // [{ "op": "mount", "node": { ... } }, { "op": "style", "id": 1, "style": { ... } }, ...]
+    for (auto v : QJsonDocument::fromJson(bytes).array()) {
+        QJsonObject o = v.toObject();
+        PreparedOp p;
+        p.op = o.value("op").toString();
+        if (p.op == "append" || p.op == "insert" || p.op == "remove") {
+            p.node = o.value("node").toObject();
+        } else if (p.op == "style") {
+            QJsonObject style = o.value("style").toObject();
+            p.node.insert("id", o.value("id"));
+            p.node.insert("style", style);
+            p.node.insert("$styleText", toStyle(style));
+        } else {
+            p.node = prepareNode(p.op, o.value("node").toObject());
+        }
+        res << p;
+    }
+    return res;
+}
+
+void Preparer::finished(int sequence, QList<PreparedOp> ops)
+{
+    {
+        QMutexLocker lock(&mutex);
+        done.insert(sequence, ops);
+    }
+    if (inlined) {
+        deliver();
+        return;
+    }
+    QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void Preparer::deliver()
+{
+    bool any = false;
+    {
+        // only the next batch in order may go out
+        QMutexLocker lock(&mutex);
+        while (done.contains(delivered)) {
+            out << done.take(delivered);
+            delivered++;
+            any = true;
+        }
+    }
+    if (any) {
+        emit ready();
+    }
+}
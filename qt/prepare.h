@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+
+// One bridge operation, parsed and with its styles compiled. Nodes carry
+// the compiled style in "$styleText" and the applyStyle fingerprint in
+// "$styleHash"; style registrations are { id, style, $styleText }.
+struct PreparedOp {
+    QString op;
+    QJsonObject node;
+};
+
+// Parses incoming bridge calls and compiles their styles on a worker
+// pool. Batches may finish out of order but are handed back in the
+// order they were submitted, ready() is emitted on the gui thread.
+class Preparer : public QObject {
+    Q_OBJECT
+public:
+    Preparer(QObject* parent = 0);
+    ~Preparer();
+
+    // 0 prepares inline on the calling thread
+    void setThreadCount(int count);
+
+    // op is commit (a json array of { op, node }) or mount, update, unmount
+    void submit(QString op, QString json);
+
+    // blocks until every submitted batch is prepared and delivered
+    void waitForDone();
+
+    // delivered operations not yet taken, in submission order
+    QList<PreparedOp> take();
+
+    // bridge calls submitted and handed back so far
+    int submittedCount() const { return submitted; }
+    int deliveredCount() const { return delivered; }
+
+    static QList<PreparedOp> prepare(QString op, QString json);
+
+    // called from the workers
+    void finished(int sequence, QList<PreparedOp> ops);
+
+signals:
+    void ready();
+
+private Q_SLOTS:
+    void deliver();
+
+private:
+    QThreadPool pool;
+    bool inlined;
+    int submitted;
+    int delivered;
+
+    QMutex mutex;
+    QMap<int, QList<PreparedOp>> done;
+    QList<PreparedOp> out;
+};
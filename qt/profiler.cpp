@@ -0,0 +1,31 @@
+#include "profiler.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+// sections may be timed on worker threads
+static QMutex mutex;
+
+bool Profiler::enabled = false;
+QMap<QString, qint64> Profiler::totals;
+
+void Profiler::setEnabled(bool on)
+{
+    QMutexLocker lock(&mutex);
+    enabled = on;
+    totals.clear();
+}
+
+void Profiler::add(const char* section, qint64 nsecs)
+{
+    QMutexLocker lock(&mutex);
+    totals[section] += nsecs;
+}
+
+QMap<QString, qint64> Profiler::take()
+{
+    QMutexLocker lock(&mutex);
+    QMap<QString, qint64> res = totals;
+    totals.clear();
+    return res;
+}
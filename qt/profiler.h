@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QString>
+
+// Accumulates time spent in named sections of the render pipeline. Used
+// by the bench harness, a single bool check when disabled.
+class Profiler {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+
+    static void add(const char* section, qint64 nsecs);
+
+    // totals in nanoseconds since the last call
+    static QMap<QString, qint64> take();
+
+private:
+    static bool enabled;
+    static QMap<QString, qint64> totals;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(const char* section)
+        : section(section)
+    {
+        if (Profiler::isEnabled()) {
+            timer.start();
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (timer.isValid()) {
+            Profiler::add(section, timer.nsecsElapsed());
+        }
+    }
+
+private:
+    const char* section;
+    QElapsedTimer timer;
+};
+
+#define PROFILE_SCOPE(section) ProfileScope _profileScope(section)
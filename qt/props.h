@@ -0,0 +1,204 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLatin1String>
+#include <QString>
+
+#include "flexlayout.h"
+
+// Typed prop schemas. Each UIObject type lists the props it understands
+// as a static table of fields; an incoming payload is decoded once into
+// a plain struct and the returned mask has the bit of every field whose
+// value actually changed.
+
+template <class T>
+T propValue(const QJsonValue& value);
+
+template <>
+inline int propValue<int>(const QJsonValue& value) { return value.toInt(); }
+
+template <>
+inline bool propValue<bool>(const QJsonValue& value) { return value.toBool(); }
+
+template <>
+inline QString propValue<QString>(const QJsonValue& value) { return value.toString(); }
+
+template <>
+inline double propValue<double>(const QJsonValue& value) { return value.toDouble(); }
+
+// a number of pixels, a "50%" string or auto
+template <>
+inline FlexLength propValue<FlexLength>(const QJsonValue& value)
+{
+    FlexLength length;
+    if (value.isDouble()) {
+        length.unit = FlexLength::Point;
+        length.value = value.toDouble();
+    } else if (value.isString() && value.toString().endsWith("%")) {
+        QString s = value.toString();
+        length.unit = FlexLength::Percent;
+        length.value = s.left(s.length() - 1).toDouble();
+    }
+    return length;
+}
+
+template <class P>
+struct PropField {
+    const char* key;
+    uint bit;
+    bool (*decode)(const QJsonValue& value, P& props);
+};
+
+template <class P, class T, T P::*member>
+bool decodeProp(const QJsonValue& value, P& props)
+{
+    T v = propValue<T>(value);
+    if (props.*member == v) {
+        return false;
+    }
+    props.*member = v;
+    return true;
+}
+
+#define PROP_FIELD(P, key, bit, T, member) \
+    { key, P::bit, decodeProp<P, T, &P::member> }
+
+// absent keys keep their value unless replace is set, then they are
+// decoded as undefined (0, false or empty)
+template <class P, size_t N>
+uint decodeProps(const PropField<P> (&schema)[N], const QJsonObject& json, P& props, bool replace = false)
+{
+    uint changed = 0;
+    for (size_t i = 0; i < N; i++) {
+        auto it = json.constFind(QLatin1String(schema[i].key));
+        if (it == json.constEnd()) {
+            if (replace && schema[i].decode(QJsonValue(QJsonValue::Undefined), props)) {
+                changed |= schema[i].bit;
+            }
+            continue;
+        }
+        if (schema[i].decode(it.value(), props)) {
+            changed |= schema[i].bit;
+        }
+    }
+    return changed;
+}
+
+// props every node understands, set through applyStyle
+struct NodeProps {
+    enum {
+        Order = 1 << 0,
+        ClassName = 1 << 1,
+        Permanent = 1 << 2,
+        Row = 1 << 3,
+        // from the style
+        Flex = 1 << 4,
+        FlexDirection = 1 << 5,
+        AlignItems = 1 << 6,
+        JustifyContent = 1 << 7,
+        FlexWrap = 1 << 8,
+        AlignContent = 1 << 9,
+        Gap = 1 << 10,
+        FlexGrow = 1 << 11,
+        FlexShrink = 1 << 12,
+        FlexBasis = 1 << 13,
+        Size = 1 << 14,
+        AlignSelf = 1 << 15,
+        Position = 1 << 16,
+        Offset = 1 << 17,
+
+        Layout = Flex | FlexDirection | AlignItems | JustifyContent | FlexWrap | AlignContent | Gap
+            | FlexGrow | FlexShrink | FlexBasis | Size | AlignSelf | Position | Offset
+    };
+
+    NodeProps()
+        : order(0)
+        , permanent(false)
+        , row(0)
+        , gap(0)
+        , rowGap(0)
+        , columnGap(0)
+        , flex(0)
+        , flexGrow(0)
+        , flexShrink(0)
+    {
+    }
+
+    int order;
+    QString className;
+    bool permanent;
+    int row;
+
+    // as a container
+    QString flexDirection;
+    QString alignItems;
+    QString justifyContent;
+    QString flexWrap;
+    QString alignContent;
+    int gap;
+    int rowGap;
+    int columnGap;
+
+    // as an item of its parent
+    double flex;
+    double flexGrow;
+    double flexShrink;
+    FlexLength flexBasis;
+    FlexLength width;
+    FlexLength height;
+    QString alignSelf;
+    QString position;
+    FlexLength left;
+    FlexLength top;
+    FlexLength right;
+    FlexLength bottom;
+};
+
+struct TextProps {
+    enum {
+        Text = 1 << 0,
+        RenderedText = 1 << 1
+    };
+
+    QString text;
+    QString renderedText;
+};
+
+struct ButtonProps {
+    enum {
+        Text = 1 << 0,
+        Checked = 1 << 1,
+        Checkable = 1 << 2,
+        Icon = 1 << 3
+    };
+
+    ButtonProps()
+        : checked(false)
+        , checkable(false)
+    {
+    }
+
+    QString text;
+    bool checked;
+    bool checkable;
+    QString icon;
+};
+
+struct TextInputProps {
+    enum {
+        Text = 1 << 0,
+        Placeholder = 1 << 1
+    };
+
+    QString text;
+    QString placeholder;
+};
+
+struct ImageProps {
+    enum {
+        Source = 1 << 0
+    };
+
+    QString source;
+};
@@ -0,0 +1,154 @@
+#include "recorder.h"
+#include "engine.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#define TRACE_HEADER "# jqn-trace 1"
+
+Recorder::Recorder(QString path)
+    : file(path)
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "unable to record to" << path;
+        return;
+    }
+    if (file.size() == 0) {
+        file.write(TRACE_HEADER "\n");
+    }
+    clock.start();
+}
+
+Recorder::~Recorder()
+{
+    flush();
+    file.close();
+}
+
+void Recorder::record(const char* op, QString payload)
+{
+    if (!file.isOpen()) {
+        return;
+    }
+    QByteArray line = QByteArray::number(clock.elapsed());
+    line += '\t';
+    line += op;
+    line += '\t';
+    // payloads are single line json, keep it that way
+    line += payload.toUtf8().replace('\n', ' ');
+    line += '\n';
+    file.write(line);
+}
+
+void Recorder::flush()
+{
+    if (file.isOpen()) {
+        file.flush();
+    }
+}
+
+Replayer::Replayer(Engine* engine, QObject* parent)
+    : QObject(parent)
+    , engine(engine)
+    , position(0)
+    , realtime(false)
+    , timer(this)
+{
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(step()));
+}
+
+QList<TraceRecord> Replayer::load(QString path)
+{
+    QList<TraceRecord> records;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "unable to open trace" << path;
+        return records;
+    }
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        if (line.isEmpty() || line.startsWith("#")) {
+            continue;
+        }
+        QStringList fields = line.split('\t');
+        if (fields.size() < 2) {
+            continue;
+        }
+        TraceRecord record;
+        record.time = fields[0].toLongLong();
+        record.op = fields[1];
+        record.payload = fields.mid(2).join('\t');
+        records << record;
+    }
+    return records;
+}
+
+bool Replayer::apply(Engine* engine, const TraceRecord& record)
+{
+    if (record.op == "commit") {
+        engine->commit(record.payload);
+    } else if (record.op == "mount") {
+        engine->mount(record.payload);
+    } else if (record.op == "update") {
+        engine->update(record.payload);
+    } else if (record.op == "unmount") {
+        engine->unmount(record.payload);
+    } else if (record.op == "create") {
+        engine->createNode(record.payload);
+    } else if (record.op == "insert" || record.op == "remove") {
+        QJsonObject move = QJsonDocument::fromJson(record.payload.toUtf8()).object();
+        int parent = move.value("parent").toInt();
+        int child = move.value("child").toInt();
+        if (record.op == "insert") {
+            engine->insertBefore(parent, child, move.value("before").toInt());
+        } else {
+            engine->removeChild(parent, child);
+        }
+    } else if (record.op == "widget") {
+        engine->widget(record.payload);
+    } else if (record.op == "render") {
+        return true;
+    }
+    return false;
+}
+
+bool Replayer::open(QString path)
+{
+    records = load(path);
+    position = 0;
+    return records.size() > 0;
+}
+
+void Replayer::start(bool rt)
+{
+    realtime = rt;
+    position = 0;
+    clock.start();
+    timer.start(0);
+}
+
+void Replayer::step()
+{
+    while (position < records.size()) {
+        const TraceRecord& record = records[position];
+        if (realtime && record.time > clock.elapsed()) {
+            timer.start(record.time - clock.elapsed());
+            return;
+        }
+        position++;
+        if (apply(engine, record)) {
+            engine->flush();
+            if (!realtime) {
+                // let the event loop process layouts between ticks
+                timer.start(0);
+                return;
+            }
+        }
+    }
+    emit finished();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class Engine;
+
+// Append-only trace of the bridge. One record per line:
+//
+//   <ms since start> <tab> <op> <tab> <payload>
+//
+// ops are mount, update, unmount, create and commit (payload is the json
+// passed from JS), insert and remove ({ parent, child, before }), widget
+// (payload is the id), event (payload is the json encoded batch sent to
+// JS) and render, a marker for each render tick.
+class Recorder {
+public:
+    Recorder(QString path);
+    ~Recorder();
+
+    bool isOpen() const { return file.isOpen(); }
+    void record(const char* op, QString payload = QString());
+    void flush();
+
+private:
+    QFile file;
+    QElapsedTimer clock;
+};
+
+struct TraceRecord {
+    qint64 time;
+    QString op;
+    QString payload;
+};
+
+// Feeds a trace back into an engine, either at the recorded pace or as
+// fast as possible, rendering at each recorded render marker. Events
+// went to JS and are not replayed.
+class Replayer : public QObject {
+    Q_OBJECT
+public:
+    Replayer(Engine* engine, QObject* parent = 0);
+
+    static QList<TraceRecord> load(QString path);
+
+    // applies one record, returns true on a render marker
+    static bool apply(Engine* engine, const TraceRecord& record);
+
+    bool open(QString path);
+    void start(bool realtime);
+
+signals:
+    void finished();
+
+private slots:
+    void step();
+
+private:
+    Engine* engine;
+    QList<TraceRecord> records;
+    int position;
+    bool realtime;
+    QElapsedTimer clock;
+    QTimer timer;
+};
@@ -0,0 +1,98 @@
+#include "stats.h"
+#include "engine.h"
+
+#include <algorithm>
+
+RollingSamples::RollingSamples(int capacity)
+    : samples(capacity, 0)
+    , next(0)
+    , total(0)
+{
+}
+
+void RollingSamples::add(qint64 value)
+{
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+    total++;
+}
+
+qint64 RollingSamples::percentile(int p) const
+{
+    int size = qMin(total, samples.size());
+    if (!size) {
+        return 0;
+    }
+    QVector<qint64> sorted = samples.mid(0, size);
+    std::sort(sorted.begin(), sorted.end());
+    int index = qBound(0, (size * p + 99) / 100 - 1, size - 1);
+    return sorted[index];
+}
+
+QVariantMap RollingSamples::toVariant() const
+{
+    QVariantMap res;
+    res.insert("count", total);
+    res.insert("p50", percentile(50) / 1000.0);
+    res.insert("p90", percentile(90) / 1000.0);
+    res.insert("p99", percentile(99) / 1000.0);
+    res.insert("max", percentile(100) / 1000.0);
+    return res;
+}
+
+StatsOverlay::StatsOverlay(Engine* engine)
+    : QLabel(0, Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint)
+    , engine(engine)
+    , timer(this)
+{
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setStyleSheet("QLabel { background: rgba(0, 0, 0, 180); color: #0f0; font-family: monospace; padding: 6px; }");
+    connect(&timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    timer.start(500);
+    refresh();
+}
+
+void StatsOverlay::refresh()
+{
+    QVariantMap stats = engine->stats();
+    QVariantMap queues = stats.value("queues").toMap();
+    QVariantMap render = stats.value("render").toMap();
+    QVariantMap events = stats.value("events").toMap();
+    QVariantMap roundTrip = events.value("roundTrip").toMap();
+
+    // pool totals over all types
+    int hits = 0;
+    int misses = 0;
+    int pooled = 0;
+    for (auto bucket : stats.value("pool").toMap()) {
+        hits += bucket.toMap().value("hits").toInt();
+        misses += bucket.toMap().value("misses").toInt();
+        pooled += bucket.toMap().value("pooled").toInt();
+    }
+
+    QString text;
+    text += QString("nodes %1  garbage %2\n")
+                .arg(stats.value("registry").toInt())
+                .arg(stats.value("garbage").toInt());
+    text += QString("queued m %1  u %2  x %3\n")
+                .arg(queues.value("mounts").toInt())
+                .arg(queues.value("updates").toInt())
+                .arg(queues.value("unmounts").toInt());
+    text += QString("render %1  p50 %2  p99 %3 ms\n")
+                .arg(render.value("count").toInt())
+                .arg(render.value("p50").toDouble(), 0, 'f', 2)
+                .arg(render.value("p99").toDouble(), 0, 'f', 2);
+    text += QString("sheets %1  relayouts %2  passes %3\n")
+                .arg(stats.value("styleSheets").toInt())
+                .arg(stats.value("relayouts").toInt())
+                .arg(stats.value("layoutPasses").toInt());
+    text += QString("pool %1  hits %2  misses %3\n")
+                .arg(pooled)
+                .arg(hits)
+                .arg(misses);
+    text += QString("events %1  rtt p50 %2 ms")
+                .arg(events.value("sent").toInt())
+                .arg(roundTrip.value("p50").toDouble(), 0, 'f', 2);
+    setText(text);
+    adjustSize();
+}
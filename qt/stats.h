@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QLabel>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+
+class Engine;
+
+// Fixed size window of the most recent samples, in microseconds.
+class RollingSamples {
+public:
+    RollingSamples(int capacity = 120);
+
+    void add(qint64 value);
+    int count() const { return total; }
+
+    // percentile over the current window, p in [0, 100]
+    qint64 percentile(int p) const;
+
+    // { count, p50, p90, p99, max } in milliseconds
+    QVariantMap toVariant() const;
+
+private:
+    QVector<qint64> samples;
+    int next;
+    int total;
+};
+
+// Small always on top window showing Engine::stats(), refreshed twice
+// a second.
+class StatsOverlay : public QLabel {
+    Q_OBJECT
+public:
+    StatsOverlay(Engine* engine);
+
+private slots:
+    void refresh();
+
+private:
+    Engine* engine;
+    QTimer timer;
+};
@@ -0,0 +1,178 @@
+#include "style.h"
+#include "core.h"
+#include "profiler.h"
+
+#include <QApplication>
+#include <QRegularExpression>
+#include <QStyle>
+
+bool StyleCompiler::hoverRules = false;
+
+StyleCompiler::StyleCompiler(QObject* parent)
+    : QObject(parent)
+    , dirty(false)
+    , applications(0)
+    , polishes(0)
+    , sheetHover(false)
+    , hoverSheets(0)
+{
+}
+
+// .hover classes, [hover] or [className~="hover"] selectors, not
+// "hoverable" and the like
+static bool hasHover(const QString& sheet)
+{
+    static const QRegularExpression hoverSelector("[.\\[]hover(?![\\w-])|=\\s*[\"'](?:[^\"']*\\s)?hover(?=[\\s\"'])");
+    return sheet.contains(hoverSelector);
+}
+
+void StyleCompiler::setRules(UIObject* obj, QString qtWidgetName, QString styleText, QJsonObject sheet)
+{
+    QWidget* w = obj->widget();
+    if (!w) {
+        return;
+    }
+
+    NodeRules& node = nodes[obj];
+    node.widget = w;
+
+    // own style, shared by all nodes with the same widget type and body
+    QString style;
+    if (!styleText.isEmpty() && !qtWidgetName.isEmpty()) {
+        style = qtWidgetName + styleText;
+    }
+    if (style != node.style) {
+        QString key;
+        if (!style.isEmpty()) {
+            if (!rules.contains(style)) {
+                // the hash only names the rule, colliding bodies get another
+                uint hash = qHash(style);
+                key = "s" + QString::number(hash, 16);
+                while (keys.contains(key)) {
+                    key = "s" + QString::number(++hash, 16);
+                }
+                Rule rule;
+                rule.key = key;
+                rule.text = "\n" + qtWidgetName + "[styleKey=\"" + key + "\"]" + styleText;
+                rule.refs = 0;
+                rule.shared = false;
+                rule.owner = obj;
+                rules.insert(style, rule);
+                keys.insert(key, style);
+            }
+            Rule& rule = rules[style];
+            if (++rule.refs == 2 && !rule.shared) {
+                // a second user moves the rule off its owner's widget
+                rule.shared = true;
+                changed.insert(rule.owner);
+                dirty = true;
+            }
+            key = rule.key;
+        }
+        releaseRule(node.style);
+        node.style = style;
+        w->setProperty("styleKey", key);
+        repolish << w;
+        changed.insert(obj);
+    }
+
+    // qss sheet, a widget sheet applies to the node and its descendants
+    QString qss;
+    if (!sheet.isEmpty()) {
+        qss = toQss(sheet);
+    }
+    if (qss != node.sheet) {
+        node.sheet = qss;
+        changed.insert(obj);
+    }
+}
+
+void StyleCompiler::removeRules(UIObject* obj)
+{
+    if (!nodes.contains(obj)) {
+        return;
+    }
+    NodeRules node = nodes.take(obj);
+    changed.remove(obj);
+    releaseRule(node.style);
+    if (hasHover(node.local)) {
+        hoverSheets--;
+    }
+}
+
+void StyleCompiler::polish(QWidget* w)
+{
+    repolish << w;
+}
+
+void StyleCompiler::releaseRule(QString style)
+{
+    if (style.isEmpty() || !rules.contains(style)) {
+        return;
+    }
+    // shared rules stay shared until unused, so churn between one and
+    // two users doesn't rebuild the application sheet
+    Rule& rule = rules[style];
+    if (--rule.refs <= 0) {
+        if (rule.shared) {
+            dirty = true;
+        }
+        keys.remove(rule.key);
+        rules.remove(style);
+    }
+}
+
+void StyleCompiler::commit()
+{
+    PROFILE_SCOPE("setStyleSheet");
+
+    // unique rules and qss sheets are set on their own widget, which
+    // re-polishes it and its descendants only
+    for (auto obj : changed) {
+        auto it = nodes.find(obj);
+        if (it == nodes.end() || !it->widget) {
+            continue;
+        }
+        QString local;
+        if (!it->style.isEmpty() && !rules.value(it->style).shared) {
+            local = rules.value(it->style).text;
+        }
+        local += it->sheet;
+        if (local == it->local) {
+            continue;
+        }
+        hoverSheets += (hasHover(local) ? 1 : 0) - (hasHover(it->local) ? 1 : 0);
+        it->local = local;
+        it->widget->setStyleSheet(local);
+        repolish.removeAll(it->widget);
+        polishes++;
+    }
+    changed.clear();
+
+    if (dirty) {
+        // rebuilding the application sheet re-polishes every widget
+        sheet.clear();
+        for (auto rule : rules) {
+            if (rule.shared) {
+                sheet += rule.text;
+            }
+        }
+        qApp->setStyleSheet(sheet);
+        applications++;
+        sheetHover = hasHover(sheet);
+        dirty = false;
+        repolish.clear();
+    }
+    hoverRules = sheetHover || hoverSheets > 0;
+
+    // otherwise only widgets whose styleKey or classes changed need a
+    // re-polish
+    for (auto w : repolish) {
+        if (w) {
+            w->style()->unpolish(w);
+            w->style()->polish(w);
+            polishes++;
+        }
+    }
+    repolish.clear();
+}
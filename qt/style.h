@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QWidget>
+
+class UIObject;
+
+// Gathers the style rules of mounted nodes. A rule is selected by the
+// widget's "styleKey" dynamic property; bodies used by more than one node
+// are shared through the application stylesheet, the others and qss
+// sheets stay on the node's own widget, so mounting a node with a unique
+// style only re-polishes that widget.
+class StyleCompiler : public QObject {
+    Q_OBJECT
+public:
+    StyleCompiler(QObject* parent = 0);
+
+    void setRules(UIObject* obj, QString qtWidgetName, QString styleText, QJsonObject sheet);
+    void removeRules(UIObject* obj);
+
+    // re-polishes a widget whose selector visible properties changed
+    void polish(QWidget* w);
+
+    // applies changed rules, called once per render tick
+    void commit();
+
+    QString styleSheet() { return sheet; }
+
+    // application sheet rebuilds and per widget re-polishes so far
+    int sheetApplications() const { return applications; }
+    int widgetPolishes() const { return polishes; }
+
+    // true when the application sheet has rules depending on hover,
+    // widgets skip re-polishing on enter/leave otherwise
+    static bool hasHoverRules() { return hoverRules; }
+
+private:
+    struct Rule {
+        QString key;
+        QString text;
+        int refs;
+        // in the application sheet, otherwise on its single user
+        bool shared;
+        UIObject* owner;
+    };
+
+    struct NodeRules {
+        QPointer<QWidget> widget;
+        QString style;
+        QString sheet;
+        // the sheet set on the widget itself
+        QString local;
+    };
+
+    void releaseRule(QString style);
+
+    // rules by widget name and style body, and the bodies by styleKey
+    QHash<QString, Rule> rules;
+    QHash<QString, QString> keys;
+    QHash<UIObject*, NodeRules> nodes;
+    QSet<UIObject*> changed;
+    QList<QPointer<QWidget>> repolish;
+    QString sheet;
+    bool dirty;
+    int applications;
+    int polishes;
+
+    // hover rules in the application sheet, and widget sheets having some
+    bool sheetHover;
+    int hoverSheets;
+
+    static bool hoverRules;
+};
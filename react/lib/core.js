@@ -8,12 +8,14 @@ import ScrollView from './scrollview';
 import SplitterView from './splitterview';
 import StackedView from './stackedview';
 import FlatList from './flatlist';
+import ListView from './listview';
 import SectionList from './sectionlist';
 import Window from './window';
 import StatusBar from './statusbar';
 import { MenuBar, Menu, MenuItem } from './menu';
 
 import StyleSheet from './stylesheet';
+import render from './renderer';
 
 export {
     View,
@@ -26,11 +28,13 @@ export {
     SplitterView,
     StackedView,
     FlatList,
+    ListView,
     SectionList,
     Window,
     StatusBar,
     MenuBar,
     Menu,
     MenuItem,
-    StyleSheet
+    StyleSheet,
+    render
 };
@@ -1,9 +1,8 @@
-import { v4 as uuid } from 'uuid';
 import StyleSheet from './stylesheet';
 
 const registry = {};
 
-const formatJson = json => {
+const formatProps = json => {
     let processed = { ...json };
     delete processed.children;
     delete processed.data;
@@ -12,49 +11,190 @@ const formatJson = json => {
             delete processed[k];
         }
         if (k === 'style') {
+            if (json[k] && json[k].__styleId) {
+                processed.styleId = json[k].__styleId;
+                delete processed[k];
+                return;
+            }
             processed[k] = StyleSheet.distillStyle(processed[k]);
         }
     });
-    return JSON.stringify(processed);
+    return processed;
 };
 
-const mount = json => {
+// the last props sent per node. updates are patches carrying only the
+// keys that changed, removed keys are listed in $removed
+const sent = {};
+
+const sameValue = (a, b) => {
+    if (a === b) {
+        return true;
+    }
+    if (!a || !b || typeof a !== 'object' || typeof b !== 'object') {
+        return false;
+    }
+    return JSON.stringify(a) === JSON.stringify(b);
+};
+
+const diffProps = props => {
+    let last = sent[props.id];
+    sent[props.id] = props;
+    if (!last) {
+        return props;
+    }
+    let patch = {};
+    let changed = false;
+    Object.keys(props).forEach(k => {
+        if (!sameValue(props[k], last[k])) {
+            patch[k] = props[k];
+            changed = true;
+        }
+    });
+    let removed = Object.keys(last).filter(k => !(k in props));
+    if (removed.length) {
+        patch.$removed = removed;
+        changed = true;
+    }
+    if (!changed) {
+        return null;
+    }
+    patch.id = props.id;
+    return patch;
+};
+
+// operations are queued and sent to the engine in one call per frame
+let batch = [];
+let flushPending = false;
+
+const flush = () => {
+    flushPending = false;
+    let ops = [...StyleSheet.takeRegistrations(), ...batch];
+    batch = [];
+    if (!ops.length) {
+        return;
+    }
     try {
-        $qt.mount(formatJson(json));
+        $qt.commit(JSON.stringify(ops));
     } catch (err) {}
 };
 
+const push = (op, node) => {
+    batch.push({ op: op, node: node });
+    if (!flushPending) {
+        flushPending = true;
+        setTimeout(flush, 0);
+    }
+};
+
+const enqueue = (op, json) => {
+    let node = formatProps(json);
+    if (op === 'mount' || op === 'create') {
+        sent[node.id] = node;
+    } else if (op === 'update') {
+        node = diffProps(node);
+        if (!node) {
+            return;
+        }
+    } else if (op === 'unmount') {
+        delete sent[node.id];
+    }
+    push(op, node);
+};
+
+const mount = json => {
+    enqueue('mount', json);
+};
+
+// node handles are reserved from the engine in blocks
+let handles = [];
+let nextLocalHandle = 1;
+
+const allocHandle = () => {
+    if (!handles.length) {
+        try {
+            handles = $qt.reserveHandles(256);
+        } catch (err) {
+            return nextLocalHandle++;
+        }
+    }
+    return handles.shift();
+};
+
 const _events = [
     'onChangeText',
     'onClick',
     'onPress',
+    'onRangeChanged',
     'onRelease',
     'onSubmitEditing'
 ];
+const bindEvents = json => {
+    // events map events
+    registry[json.id] = registry[json.id] || {};
+
+    _events.forEach(e => {
+        registry[json.id][e] = json[e] || (evt => {});
+    });
+};
+
 const update = json => {
     try {
-        $qt.update(formatJson(json));
-
-        // events map events
-        registry[json.id] = registry[json.id] || {};
+        enqueue('update', json);
+        bindEvents(json);
+    } catch (err) {}
+};
 
-        _events.forEach(e => {
-            registry[json.id][e] = json[e] || (evt => {});
-        });
+// host operations used by the renderer. nodes are created detached and
+// placed explicitly, so the tree is known without a DOM
+const createNode = json => {
+    try {
+        enqueue('create', json);
+        bindEvents(json);
     } catch (err) {}
 };
 
+const appendChild = (parent, child) => {
+    push('append', { parent: parent, child: child });
+};
+
+const insertBefore = (parent, child, before) => {
+    push('insert', { parent: parent, child: child, before: before });
+};
+
+const removeChild = (parent, child) => {
+    push('remove', { parent: parent, child: child });
+    delete sent[child];
+    delete registry[child];
+};
+
+const commitUpdate = update;
+
+// native events arrive in batches of [handle, event, value]
+const dispatch = events => {
+    events.forEach(([id, event, value]) => {
+        let handlers = registry[id];
+        if (handlers && handlers[event]) {
+            handlers[event]({ target: { src: id, value: value } });
+        }
+    });
+};
+
+try {
+    $qt.events.connect(dispatch);
+} catch (err) {}
+
 const unmount = json => {
     try {
-        $qt.unmount(formatJson(json));
+        enqueue('unmount', json);
         delete registry[json.id];
     } catch (err) {}
 };
 
 const widget = id => {
     return new Promise((resolve, reject) => {
-        $qt.widget(id);
-        let cid = id.replace(/:/g, '_');
+        flush();
+        $qt.widget(String(id));
+        let cid = String(id).replace(/:/g, '_');
         let wid = `$widgets_${cid}`;
         setTimeout(() => {
             let widget = window[wid];
@@ -68,7 +208,14 @@ const engine = {
     mount,
     unmount,
     update,
-    widget
+    createNode,
+    appendChild,
+    insertBefore,
+    removeChild,
+    commitUpdate,
+    widget,
+    flush,
+    allocHandle
 };
 
 window.$widgets = registry;
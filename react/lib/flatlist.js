@@ -1,10 +1,8 @@
 import React from 'react';
-import View from './view';
-import Text from './text';
-import ScrollView from './scrollview';
-import { v4 as uuid } from 'uuid';
-import qt from './engine';
+import { VirtualList } from './listview';
 
+// a row's item is passed to renderItem on every render; with a
+// keyExtractor an item keeps its row widget when the data shifts
 const FlatList_ = props => {
     const [state, setState] = React.useState({
         renderItem: props.renderItem
@@ -12,36 +10,36 @@ const FlatList_ = props => {
 
     let data = props.data || [];
     const Item = state.renderItem;
-    const keyExtractor = props.keyExtractor || ((item, index) => item + index);
 
     if (!data.map) {
         data = [];
     }
 
-    // data = data.slice(0, 20);
-
-    const renderedItems = data.map((item, index) => {
-        return (
-            <Item
-                item={item}
-                index={index}
-                {...(props.extraData || {})}
-                key={keyExtractor(item, index)}
-            />
-        );
-    });
+    // stable while the data is, so VirtualList skips unrelated renders
+    const renderRow = React.useCallback(
+        index => (
+            <Item item={data[index]} index={index} {...(props.extraData || {})} />
+        ),
+        [props.data, Item, props.extraData]
+    );
+
+    const keyExtractor = props.keyExtractor;
+    const rowKey = React.useCallback(
+        index => keyExtractor(data[index], index),
+        [props.data, keyExtractor]
+    );
 
     return (
-        <ScrollView {...props}>
-            <View
-                style={{
-                    'flex-direction': 'column',
-                    'align-items': 'flex-start'
-                }}
-            >
-                {renderedItems}
-            </View>
-        </ScrollView>
+        <VirtualList
+            style={props.style}
+            className={props.className}
+            rowHeight={props.rowHeight}
+            overscan={props.overscan}
+            initialNumToRender={props.initialNumToRender}
+            count={data.length}
+            renderRow={renderRow}
+            rowKey={keyExtractor ? rowKey : undefined}
+        />
     );
 };
 
@@ -0,0 +1,85 @@
+import React from 'react';
+import View from './view';
+
+const ListView = props => {
+    return <View {...props} type="ListView" />;
+};
+
+// renders only the rows the native ListView reports as visible; rows are
+// keyed by slot so their native widgets are recycled while scrolling. a
+// row keeps its slot while its key (rowKey, or its index) stays in range,
+// rows leaving the range hand theirs to the rows entering it. without a
+// rowHeight the native side estimates one from the first rows
+const VirtualList_ = props => {
+    const [range, setRange] = React.useState({
+        first: 0,
+        last: (props.initialNumToRender || 20) - 1
+    });
+    const slots = React.useRef({ byKey: {}, free: [], next: 0 });
+
+    const count = props.count || 0;
+    const first = Math.min(range.first, Math.max(count - 1, 0));
+    const last = Math.min(range.last, count - 1);
+
+    let keys = {};
+    let slotOf = {};
+    for (let i = first; i <= last; i++) {
+        let key = props.rowKey ? String(props.rowKey(i)) : String(i);
+        if (keys[key] !== undefined) {
+            // duplicate keys fall back to the index
+            key = `${key}#${i}`;
+        }
+        keys[key] = i;
+    }
+
+    let current = slots.current;
+    let byKey = {};
+    Object.keys(current.byKey).forEach(k => {
+        if (keys[k] !== undefined) {
+            byKey[k] = current.byKey[k];
+        } else {
+            current.free.push(current.byKey[k]);
+        }
+    });
+    Object.keys(keys).forEach(k => {
+        if (byKey[k] === undefined) {
+            byKey[k] = current.free.length ? current.free.pop() : current.next++;
+        }
+        slotOf[keys[k]] = byKey[k];
+    });
+    current.byKey = byKey;
+
+    const rows = [];
+    for (let i = first; i <= last; i++) {
+        rows.push(
+            <View key={`row-${slotOf[i]}`} row={i}>
+                {props.renderRow(i)}
+            </View>
+        );
+    }
+
+    const onRangeChanged = evt => {
+        let value = evt.target.value;
+        if (value.first !== range.first || value.last !== range.last) {
+            setRange({ first: value.first, last: value.last });
+        }
+    };
+
+    return (
+        <ListView
+            style={props.style}
+            className={props.className}
+            rowHeight={props.rowHeight}
+            overscan={props.overscan}
+            count={count}
+            onRangeChanged={onRangeChanged}
+        >
+            {rows}
+        </ListView>
+    );
+};
+
+const VirtualList = React.memo(VirtualList_);
+
+export { ListView, VirtualList };
+export default ListView;
@@ -0,0 +1,264 @@
+import Reconciler from 'react-reconciler';
+import clsx from 'clsx';
+import qt from './engine';
+
+// native nodes are the capitalized host types (View, Text, ...). lowercase
+// tags and strings are inline content, they only live here and are sent
+// as renderedText of the nearest native node
+const isNative = type => type && type[0] === type[0].toUpperCase();
+
+const escapeText = text =>
+    String(text)
+        .replace(/&/g, '&amp;')
+        .replace(/</g, '&lt;')
+        .replace(/>/g, '&gt;');
+
+const toHtml = node => {
+    if (node.text !== undefined) {
+        return escapeText(node.text);
+    }
+    let inner = node.children.map(toHtml).join('');
+    if (node.native) {
+        return inner;
+    }
+    let cls = node.props.className ? ` class="${node.props.className}"` : '';
+    return `<${node.type}${cls}>${inner}</${node.type}>`;
+};
+
+const ownerOf = node => {
+    while (node && !node.native) {
+        node = node.parent;
+    }
+    return node;
+};
+
+// native children, looking through inline wrappers
+const nativeChildren = node => {
+    let res = [];
+    node.children.forEach(c => {
+        if (c.native) {
+            res.push(c);
+        } else if (c.children) {
+            res = res.concat(nativeChildren(c));
+        }
+    });
+    return res;
+};
+
+const hasInline = node => node.children.some(c => !c.native);
+
+const nodeProps = node => {
+    let props = node.props;
+    let res = {
+        ...props,
+        type: node.type,
+        id: node.handle,
+        alias: props.id,
+        persistent: props.id,
+        className: clsx('qt', node.type, props.className)
+    };
+    if (hasInline(node)) {
+        res.renderedText = node.children.map(toHtml).join('');
+    }
+    return res;
+};
+
+// native nodes whose inline content changed during a commit
+let dirty = new Set();
+
+const touch = node => {
+    let owner = ownerOf(node);
+    if (owner && owner.handle) {
+        dirty.add(owner);
+    }
+};
+
+const attach = (parent, child, before) => {
+    child.parent = parent;
+    let index = before ? parent.children.indexOf(before) : -1;
+    let current = parent.children.indexOf(child);
+    if (current !== -1) {
+        parent.children.splice(current, 1);
+        if (current < index) {
+            index--;
+        }
+    }
+    if (index === -1) {
+        parent.children.push(child);
+    } else {
+        parent.children.splice(index, 0, child);
+    }
+
+    let owner = ownerOf(parent);
+    if (!child.native) {
+        touch(parent);
+    }
+    if (!owner) {
+        return;
+    }
+    // the native nodes placed go before the next native node of the
+    // owner, wherever inline wrappers put it. top level nodes go to the
+    // container, handle 0. the engine creates nodes once placed
+    let placed = child.native ? [child] : nativeChildren(child);
+    if (!placed.length) {
+        return;
+    }
+    let siblings = nativeChildren(owner);
+    let next = siblings[siblings.indexOf(placed[placed.length - 1]) + 1];
+    placed.forEach(c => {
+        if (next) {
+            qt.insertBefore(owner.handle, c.handle, next.handle);
+        } else {
+            qt.appendChild(owner.handle, c.handle);
+        }
+    });
+};
+
+const detach = (parent, child) => {
+    let index = parent.children.indexOf(child);
+    if (index !== -1) {
+        parent.children.splice(index, 1);
+    }
+    child.parent = null;
+
+    // the whole native subtree is unmounted, parents first
+    let removed = child.native ? [child] : nativeChildren(child);
+    let owner = ownerOf(parent);
+    if (!child.native) {
+        touch(parent);
+    }
+    const unmount = node => {
+        dirty.delete(node);
+        nativeChildren(node).forEach(c => {
+            qt.removeChild(node.handle, c.handle);
+            unmount(c);
+        });
+    };
+    removed.forEach(node => {
+        qt.removeChild(owner ? owner.handle : 0, node.handle);
+        unmount(node);
+    });
+};
+
+const shallowEqual = (a, b) => {
+    let keys = Object.keys(a).filter(k => k !== 'children');
+    if (keys.length !== Object.keys(b).filter(k => k !== 'children').length) {
+        return false;
+    }
+    return keys.every(k => a[k] === b[k]);
+};
+
+const hostConfig = {
+    now: Date.now,
+    scheduleTimeout: setTimeout,
+    cancelTimeout: clearTimeout,
+    noTimeout: -1,
+    isPrimaryRenderer: true,
+    supportsMutation: true,
+    supportsPersistence: false,
+    supportsHydration: false,
+
+    getRootHostContext: () => ({}),
+    getChildHostContext: parentContext => parentContext,
+    getPublicInstance: instance => instance,
+    shouldSetTextContent: () => false,
+    shouldDeprioritizeSubtree: () => false,
+
+    createInstance: (type, props) => {
+        let node = {
+            type: type,
+            props: props,
+            children: [],
+            parent: null,
+            native: isNative(type)
+        };
+        if (node.native) {
+            node.handle = qt.allocHandle();
+        }
+        return node;
+    },
+
+    createTextInstance: text => ({
+        text: text,
+        parent: null,
+        native: false
+    }),
+
+    appendInitialChild: (parent, child) => {
+        child.parent = parent;
+        parent.children.push(child);
+    },
+
+    finalizeInitialChildren: node => {
+        if (!node.native) {
+            return false;
+        }
+        // children were created first, they are placed once the parent exists
+        qt.createNode(nodeProps(node));
+        nativeChildren(node).forEach(c => {
+            qt.appendChild(node.handle, c.handle);
+        });
+        return false;
+    },
+
+    prepareForCommit: () => null,
+
+    resetAfterCommit: () => {
+        dirty.forEach(node => {
+            qt.commitUpdate(nodeProps(node));
+        });
+        dirty.clear();
+        qt.flush();
+    },
+
+    prepareUpdate: (node, type, oldProps, newProps) =>
+        shallowEqual(oldProps, newProps) ? null : true,
+
+    commitUpdate: (node, payload, type, oldProps, newProps) => {
+        node.props = newProps;
+        if (node.native) {
+            dirty.delete(node);
+            qt.commitUpdate(nodeProps(node));
+        } else {
+            touch(node);
+        }
+    },
+
+    commitTextUpdate: (node, oldText, newText) => {
+        node.text = newText;
+        touch(node);
+    },
+
+    commitMount: () => {},
+    resetTextContent: () => {},
+
+    appendChild: (parent, child) => attach(parent, child, null),
+    appendChildToContainer: (container, child) => attach(container, child, null),
+    insertBefore: (parent, child, before) => attach(parent, child, before),
+    insertInContainerBefore: (container, child, before) =>
+        attach(container, child, before),
+    removeChild: (parent, child) => detach(parent, child),
+    removeChildFromContainer: (container, child) => detach(container, child),
+    clearContainer: () => {},
+
+    hideInstance: () => {},
+    unhideInstance: () => {},
+    hideTextInstance: () => {},
+    unhideTextInstance: () => {}
+};
+
+const reconciler = Reconciler(hostConfig);
+
+// the container stands for the engine root, handle 0
+const container = { handle: 0, children: [], parent: null, native: true };
+let root = null;
+
+const render = (element, callback) => {
+    if (!root) {
+        root = reconciler.createContainer(container, 0, false, null);
+    }
+    reconciler.updateContainer(element, root, null, callback);
+};
+
+export { render };
+export default render;
@@ -1,10 +1,8 @@
 import React from 'react';
-import View from './view';
-import Text from './text';
-import ScrollView from './scrollview';
-import { v4 as uuid } from 'uuid';
-import qt from './engine';
+import { VirtualList } from './listview';
 
+// with a keyExtractor an item keeps its row widget when the data shifts,
+// keys are scoped to their section
 const SectionList_ = props => {
     const [state, setState] = React.useState({
         renderItem: props.renderItem,
@@ -14,52 +12,70 @@ const SectionList_ = props => {
     let data = props.data || [];
     const Item = state.renderItem;
     const Header = state.renderSectionHeader;
-    const keyExtractor = props.keyExtractor || ((item, index) => item + index);
 
     if (!data.map) {
         data = [];
     }
-    
+
     if (props.maxItems) {
         data = data.slice(0, props.maxItems);
     }
 
-    const renderedItems = data.map((section, sectionIndex) => {
-        const sectionItems = section.data.map((item, index) => {
+    // sections are flattened into header and item rows
+    const rows = React.useMemo(() => {
+        let res = [];
+        data.forEach((section, sectionIndex) => {
+            res.push({ section: sectionIndex });
+            (section.data || []).forEach((item, index) => {
+                res.push({ section: sectionIndex, index: index });
+            });
+        });
+        return res;
+    }, [props.data, props.maxItems]);
+
+    const renderRow = React.useCallback(
+        i => {
+            const row = rows[i];
+            const section = data[row.section];
+            if (row.index === undefined) {
+                return <Header section={section} {...(props.extraData || {})} />;
+            }
             return (
                 <Item
-                    item={item}
-                    index={index}
+                    item={section.data[row.index]}
+                    index={row.index}
+                    section={section}
                     {...(props.extraData || {})}
-                    key={keyExtractor(item, index)}
                 />
             );
-        });
+        },
+        [rows, Item, Header, props.extraData]
+    );
 
-        return (
-            <React.Fragment
-                key={
-                    `seclist-${sectionIndex}` +
-                    keyExtractor(section, sectionIndex)
-                }
-            >
-                <Header section={section} {...(props.extraData || {})} />
-                {sectionItems}
-            </React.Fragment>
-        );
-    });
+    const keyExtractor = props.keyExtractor;
+    const rowKey = React.useCallback(
+        i => {
+            const row = rows[i];
+            if (row.index === undefined) {
+                return `${row.section}`;
+            }
+            const item = data[row.section].data[row.index];
+            return `${row.section}:${keyExtractor(item, row.index)}`;
+        },
+        [rows, keyExtractor]
+    );
 
     return (
-        <ScrollView {...props}>
-            <View
-                style={{
-                    'flex-direction': 'column',
-                    'align-items': 'flex-start'
-                }}
-            >
-                {renderedItems}
-            </View>
-        </ScrollView>
+        <VirtualList
+            style={props.style}
+            className={props.className}
+            rowHeight={props.rowHeight}
+            overscan={props.overscan}
+            initialNumToRender={props.initialNumToRender}
+            count={rows.length}
+            renderRow={renderRow}
+            rowKey={keyExtractor ? rowKey : undefined}
+        />
     );
 };
 
@@ -39,12 +39,34 @@ const distillStyle = style => {
     return res;
 };
 
+// styles from StyleSheet.create are sent to the engine once and
+// referenced by handle; spreading a style drops the handle
+let nextStyleId = 1;
+let registrations = [];
+
+const registerStyle = style => {
+    let id = nextStyleId++;
+    registrations.push({ op: 'style', id: id, style: style });
+    Object.defineProperty(style, '__styleId', {
+        value: id,
+        enumerable: false
+    });
+    return style;
+};
+
+const takeRegistrations = () => {
+    let res = registrations;
+    registrations = [];
+    return res;
+};
+
 const StyleSheet = {
     distillStyle,
+    takeRegistrations,
     create: styles => {
         let res = {};
         Object.keys(styles).forEach(k => {
-            res[k] = distillStyle(styles[k]);
+            res[k] = registerStyle(distillStyle(styles[k]));
         });
         console.log(res);
         return res;
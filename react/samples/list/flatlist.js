@@ -1,6 +1,12 @@
 import React from 'react';
-import ReactDOM from 'react-dom';
-import { Window, View, FlatList, Text, StyleSheet } from '../../lib/core';
+import {
+    Window,
+    View,
+    FlatList,
+    Text,
+    StyleSheet,
+    render
+} from '../../lib/core';
 
 const DATA = [
     {
@@ -37,7 +43,8 @@ function App() {
                 <FlatList
                     data={DATA}
                     renderItem={({ item }) => <Item title={item.title} />}
-                    keyExtractor={(item, index) => item + index}
+                    keyExtractor={item => item.id}
+                    rowHeight={96}
                 />
             </View>
         </Window>
@@ -65,4 +72,4 @@ const styles = StyleSheet.create({
     }
 });
 
-ReactDOM.render(<App />, document.getElementById('root'));
+render(<App />);
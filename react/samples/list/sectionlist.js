@@ -1,6 +1,12 @@
 import React from 'react';
-import ReactDOM from 'react-dom';
-import { Window, View, SectionList, Text, StyleSheet } from '../../lib/core';
+import {
+    Window,
+    View,
+    SectionList,
+    Text,
+    StyleSheet,
+    render
+} from '../../lib/core';
 
 const DATA = [
     {
@@ -76,10 +82,11 @@ const styles = StyleSheet.create({
     }
 });
 
-const qss = StyleSheet.create({
+// qss is sent as is, not registered like the styles above
+const qss = {
     'QScrollBar:vertical': {
-        backgroundColor: 'yellow'
+        background: 'yellow'
     }
-});
+};
 
-ReactDOM.render(<App />, document.getElementById('root'));
+render(<App />);
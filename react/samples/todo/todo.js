@@ -1,5 +1,4 @@
 import React from 'react';
-import ReactDOM from 'react-dom';
 import { v4 as uuid } from 'uuid';
 
 import qt from '../../lib/engine';
@@ -19,7 +18,8 @@ import {
     MenuBar,
     Menu,
     MenuItem,
-    StyleSheet
+    StyleSheet,
+    render
 } from '../../lib/core';
 
 import { useTodos, StoreProvider as TodosProvider } from './context';
@@ -232,9 +232,8 @@ const styles = StyleSheet.create({
     }
 });
 
-ReactDOM.render(
+render(
     <TodosProvider>
         <App />
-    </TodosProvider>,
-    document.getElementById('root')
+    </TodosProvider>
 );